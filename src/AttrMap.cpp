@@ -1,20 +1,23 @@
 #include "AttrMap.h"
-#include "NodeVal.h"
+#include <algorithm>
 using namespace std;
 
-void AttrMap::copyFrom(const AttrMap &other) {
-    attrMap.clear();
-    for (const auto &loc : other.attrMap) {
-        attrMap.insert({loc.first, make_unique<NodeVal>(*loc.second)});
-    }
+static bool entryNameLess(const AttrMap::Entry &entry, NamePool::Id name) {
+    return entry.name.id < name.id;
 }
 
-AttrMap::AttrMap(const AttrMap &other) {
-    copyFrom(other);
-}
+const NodeVal* AttrMap::find(NamePool::Id name) const {
+    auto loc = lower_bound(entries.begin(), entries.end(), name, entryNameLess);
+    if (loc == entries.end() || loc->name != name) return nullptr;
 
-void AttrMap::operator=(const AttrMap &other) {
-    if (this != &other) copyFrom(other);
+    return &loc->val;
 }
 
-AttrMap::~AttrMap() {}
\ No newline at end of file
+bool AttrMap::insert(NamePool::Id name, NodeVal val) {
+    auto loc = lower_bound(entries.begin(), entries.end(), name, entryNameLess);
+    if (loc != entries.end() && loc->name == name) return false;
+
+    entries.insert(loc, Entry{name, move(val)});
+
+    return true;
+}
\ No newline at end of file
@@ -1,22 +1,31 @@
 #pragma once
 
-#include <memory>
-#include <unordered_map>
+#include "llvm/ADT/SmallVector.h"
 #include "NamePool.h"
+#include "NodeVal.h"
 
-class NodeVal;
-
-struct AttrMap {
-    std::unordered_map<NamePool::Id, std::unique_ptr<NodeVal>, NamePool::Id::Hasher> attrMap;
+// attributes sorted by name, there are rarely more than a few
+class AttrMap {
+public:
+    struct Entry {
+        NamePool::Id name;
+        NodeVal val;
+    };
 
 private:
-    void copyFrom(const AttrMap &other);
+    llvm::SmallVector<Entry, 4> entries;
 
 public:
-    AttrMap() = default;
+    bool empty() const { return entries.empty(); }
+    std::size_t size() const { return entries.size(); }
 
-    AttrMap(const AttrMap &other);
-    void operator=(const AttrMap &other);
+    // returns nullptr if not found
+    const NodeVal* find(NamePool::Id name) const;
+    // returns false if already present
+    bool insert(NamePool::Id name, NodeVal val);
 
-    ~AttrMap();
+    const Entry* begin() const { return entries.begin(); }
+    const Entry* end() const { return entries.end(); }
+    Entry* begin() { return entries.begin(); }
+    Entry* end() { return entries.end(); }
 };
\ No newline at end of file
@@ -0,0 +1,80 @@
+#pragma once
+
+#include <cstdint>
+#include <memory_resource>
+#include <new>
+#include <utility>
+
+// holds a value out of line, so that the owner stays small
+// nothing is allocated until the value is first written, reads before that see T()
+// the value may be placed in an arena, it is then destroyed here but its memory is left to the arena
+template<typename T>
+class Boxed {
+    // the lowest bit marks a value placed in an arena
+    std::uintptr_t bits = 0;
+
+    static const T& defaultVal() {
+        static const T val{};
+        return val;
+    }
+
+    T* ptr() const { return reinterpret_cast<T*>(bits&~std::uintptr_t(1)); }
+    bool inArena() const { return (bits&1) != 0; }
+
+    void release() {
+        T *p = ptr();
+        if (p != nullptr) {
+            if (inArena()) p->~T();
+            else delete p;
+        }
+        bits = 0;
+    }
+
+    static std::uintptr_t copyOf(const Boxed &other) {
+        // copies are never placed in the arena, as they may outlive it
+        return other.bits == 0 ? 0 : reinterpret_cast<std::uintptr_t>(new T(*other.ptr()));
+    }
+
+public:
+    Boxed() = default;
+    explicit Boxed(T val) : bits(reinterpret_cast<std::uintptr_t>(new T(std::move(val)))) {}
+    Boxed(T val, std::pmr::memory_resource *arena) {
+        static_assert(alignof(T) > 1);
+        void *mem = arena->allocate(sizeof(T), alignof(T));
+        bits = reinterpret_cast<std::uintptr_t>(new (mem) T(std::move(val)))|1;
+    }
+
+    Boxed(const Boxed &other) : bits(copyOf(other)) {}
+    Boxed& operator=(const Boxed &other) {
+        // copy before releasing, other may be owned by the current value
+        if (this != &other) {
+            std::uintptr_t copy = copyOf(other);
+            release();
+            bits = copy;
+        }
+        return *this;
+    }
+
+    Boxed(Boxed &&other) noexcept : bits(other.bits) { other.bits = 0; }
+    Boxed& operator=(Boxed &&other) noexcept {
+        // take over before releasing, other may be owned by the current value
+        if (this != &other) {
+            std::uintptr_t taken = other.bits;
+            other.bits = 0;
+            release();
+            bits = taken;
+        }
+        return *this;
+    }
+
+    ~Boxed() { release(); }
+
+    bool isAllocated() const { return bits != 0; }
+    void reset() { release(); }
+
+    T& get() {
+        if (bits == 0) bits = reinterpret_cast<std::uintptr_t>(new T());
+        return *ptr();
+    }
+    const T& get() const { return bits == 0 ? defaultVal() : *ptr(); }
+};
\ No newline at end of file
@@ -13,7 +13,7 @@
 #include "utils.h"
 using namespace std;
 
-bool buildExecutable(const ProgramArgs &args, const std::string &objFile) {
+bool buildExecutable(const ProgramArgs &args, const std::vector<std::string> &objFiles) {
     string clangPath = llvm::sys::findProgramByName("clang").get();
 
     clang::IntrusiveRefCntPtr<clang::DiagnosticOptions> diagOpt(new clang::DiagnosticOptions());
@@ -22,10 +22,18 @@ bool buildExecutable(const ProgramArgs &args, const std::string &objFile) {
 
     clang::driver::Driver driver(clangPath, llvm::sys::getDefaultTargetTriple(), diags);
 
+    string optLvlArg = args.optLvl.has_value() ? "-O"+to_string(args.optLvl.value()) : "";
+
     vector<const char*> clangArgs;
     clangArgs.push_back(clangPath.c_str());
-    if (args.optLvl.has_value()) clangArgs.push_back((string("-O")+to_string(args.optLvl.value())).c_str());
-    if (!objFile.empty()) clangArgs.push_back(objFile.c_str());
+    if (!optLvlArg.empty()) clangArgs.push_back(optLvlArg.c_str());
+    // links in the profile runtime
+    if (args.profileGenerate) clangArgs.push_back("-fprofile-generate");
+    // bitcode inputs get optimized and compiled together by the linker, which must be one that reads LLVM bitcode
+    if (args.lto == ProgramArgs::LTO_THIN) clangArgs.push_back("-flto=thin");
+    else if (args.lto == ProgramArgs::LTO_FULL) clangArgs.push_back("-flto=full");
+    if (args.lto != ProgramArgs::LTO_NONE) clangArgs.push_back("-fuse-ld=lld");
+    for (const string &obj : objFiles) clangArgs.push_back(obj.c_str());
     for (const string &in : args.inputsOther) clangArgs.push_back(in.c_str());
     clangArgs.push_back("-o");
     clangArgs.push_back(args.outputBin.c_str());
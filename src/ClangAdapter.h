@@ -1,6 +1,7 @@
 #pragma once
 
 #include <string>
+#include <vector>
 #include "ProgramArgs.h"
 
-bool buildExecutable(const ProgramArgs &args, const std::string &objFile);
+bool buildExecutable(const ProgramArgs &args, const std::vector<std::string> &objFiles);
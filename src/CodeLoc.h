@@ -1,21 +1,32 @@
 #pragma once
 
+#include <cstdint>
 #include <iostream>
 #include <string>
 #include "StringPool.h"
 
 typedef std::size_t CodeIndex;
 
+// position in any of the source files, files are laid out one after another by SourceManager
+// 0 is not in any file
+typedef std::uint32_t CodeOffset;
+
+// decoded position in a single file
 struct CodeLocPoint {
     CodeIndex ln, col;
 };
 
+// trivial, so that it can be kept in unions, CodeLoc() is not in any file
 struct CodeLoc {
-    StringPool::Id file;
-    CodeLocPoint start;
-    CodeLocPoint end; // points to a position after code loc
+    CodeOffset start;
+    std::uint32_t len;
+
+    // points to a position after code loc
+    CodeOffset end() const { return start+len; }
+
+    static CodeLoc make(CodeOffset start, CodeOffset end) { return CodeLoc{start, end-start}; }
 };
 
 // for debugging
 std::ostream& operator<<(std::ostream &out, CodeLocPoint locPnt);
-std::ostream& operator<<(std::ostream &out, CodeLoc loc);
\ No newline at end of file
+std::ostream& operator<<(std::ostream &out, CodeLoc loc);
@@ -1,6 +1,5 @@
 #include "CompilationMessages.h"
 #include <filesystem>
-#include <fstream>
 #include <sstream>
 #include "NamePool.h"
 #include "terminalSequences.h"
@@ -168,6 +167,7 @@ string CompilationMessages::errorStringOfType(TypeTable::Id ty) const {
                 if (i > 0) ss << ' ';
                 ss << errorStringOfType(callable.getArgType(i));
                 if (callable.getArgNoDrop(i)) ss << "::noDrop";
+                if (callable.getArgNoAlias(i)) ss << "::noAlias";
             }
             ss << ")";
             if (callable.variadic) ss << "::variadic";
@@ -200,16 +200,21 @@ string CompilationMessages::errorStringOfType(TypeTable::Id ty) const {
     return ss.str();
 }
 
-string toString(CodeLoc loc, const StringPool *stringPool) {
+string toString(CodeLoc loc, const SourceManager *sourceManager, const StringPool *stringPool) {
+    const SourceFile *src = sourceManager->find(loc);
+    if (src == nullptr) return "";
+
+    CodeLocPoint start = src->getPoint(loc.start);
+
     stringstream ss;
-    const string &file = stringPool->get(loc.file);
+    const string &file = stringPool->get(src->getFile());
     ss << filesystem::relative(file).string();
-    ss << ':' << loc.start.ln << ':' << loc.start.col << ':';
+    ss << ':' << start.ln << ':' << start.col << ':';
     return ss.str();
 }
 
 void CompilationMessages::heading(CodeLoc loc) {
-    (*out) << terminalSetBold() << toString(loc, stringPool) << ' ' << terminalReset();
+    (*out) << terminalSetBold() << toString(loc, sourceManager, stringPool) << ' ' << terminalReset();
 }
 
 void CompilationMessages::bolded(const string &str) {
@@ -268,17 +273,17 @@ void CompilationMessages::error(CodeLoc loc, const string &str) {
 }
 
 void CompilationMessages::displayCodeSegment(CodeLoc loc) {
-    const string &filename = stringPool->get(loc.file);
-    ifstream file(filename);
-    if (!file.is_open()) return;
+    const SourceFile *src = sourceManager->find(loc);
+    if (src == nullptr) return;
 
-    string line;
-    for (CodeIndex i = 0; i < loc.start.ln; ++i) getline(file, line);
+    CodeLocPoint locStart = src->getPoint(loc.start), locEnd = src->getPoint(loc.end());
+
+    string_view line = src->getLine(locStart.ln);
     (*out) << line << endl;
 
-    bool multiline = loc.start.ln < loc.end.ln;
-    CodeIndex start = loc.start.col-1;
-    CodeIndex end = multiline ? line.size() : loc.end.col-1;
+    bool multiline = locStart.ln < locEnd.ln;
+    CodeIndex start = locStart.col-1;
+    CodeIndex end = multiline ? line.size() : locEnd.col-1;
     if (end <= start) end = start+1;
     while (end > start && isspace(line[end-1])) --end;
 
@@ -386,7 +391,7 @@ void CompilationMessages::hintWhileProcessingRetType(CodeLoc loc) {
 }
 
 void CompilationMessages::warnUnusedSpecial(CodeLoc loc, SpecialVal spec) {
-    optional<Keyword> k = getKeyword(spec.id);
+    optional<Keyword> k = getKeyword(spec.id, namePool);
 
     stringstream ss;
     ss << "Unused special found in a block body";
@@ -426,6 +431,12 @@ void CompilationMessages::errorInputFileNotFound(const string &path) {
     error(ss.str());
 }
 
+void CompilationMessages::errorFileNotWritten(const string &path) {
+    stringstream ss;
+    ss << "Could not write file " << path << ".";
+    error(ss.str());
+}
+
 void CompilationMessages::errorBadToken(CodeLoc loc) {
     error(loc, "Could not parse token.");
 }
@@ -741,6 +752,12 @@ void CompilationMessages::errorFuncNotEvalOrCompiled(CodeLoc loc) {
     error(loc, "Function set as neither evaluable nor compilable.");
 }
 
+void CompilationMessages::errorFuncConflictingAttrs(CodeLoc loc, const std::string &attr0, const std::string &attr1) {
+    stringstream ss;
+    ss << "Function attributes '" << attr0 << "' and '" << attr1 << "' cannot be used together.";
+    error(loc, ss.str());
+}
+
 void CompilationMessages::errorMacroNameTaken(CodeLoc loc, NamePool::Id name) {
     stringstream ss;
     ss << "Name '" << namePool->get(name) << "' was already taken and cannot be used for a macro.";
@@ -779,6 +796,10 @@ void CompilationMessages::errorArgNameDuplicate(CodeLoc loc, NamePool::Id name)
     error(loc, ss.str());
 }
 
+void CompilationMessages::errorArgNoAliasNonPointer(CodeLoc loc) {
+    error(loc, "Only arguments of pointer types may be marked as 'noAlias'.");
+}
+
 void CompilationMessages::errorFuncNotFound(CodeLoc loc, vector<TypeTable::Id> argTys, optional<NamePool::Id> name) {
     stringstream ss;
     ss << "No functions";
@@ -835,6 +856,22 @@ void CompilationMessages::errorDataRedefinition(CodeLoc loc, NamePool::Id name)
     error(loc, ss.str());
 }
 
+void CompilationMessages::errorDataBadAlignment(CodeLoc loc) {
+    stringstream ss;
+    ss << "Data alignment must be a positive power of two, at most " << TypeTable::DataType::kMaxAlignment << ".";
+    error(loc, ss.str());
+}
+
+void CompilationMessages::errorDataPackedAligned(CodeLoc loc) {
+    error(loc, "Data type cannot be both packed and aligned.");
+}
+
+void CompilationMessages::errorDataAlignmentUnsupported(CodeLoc loc, std::uint64_t alignment) {
+    stringstream ss;
+    ss << "Data alignment of " << alignment << " is not supported on the target.";
+    error(loc, ss.str());
+}
+
 void CompilationMessages::errorBlockBareNameType(CodeLoc loc) {
     error(loc, "Bare blocks cannot have names nor pass types. They are simply unscoped sequences of instructions.");
 }
@@ -1032,4 +1069,10 @@ void CompilationMessages::errorUnknown(CodeLoc loc) {
 
 void CompilationMessages::errorInternal(CodeLoc loc) {
     error(loc, "An internal error occured. You should not be seeing this.");
+}
+
+void CompilationMessages::errorInternalBadCode(const string &funcName) {
+    stringstream ss;
+    ss << "Generated code of function '" << funcName << "' is malformed. You should not be seeing this.";
+    error(ss.str());
 }
\ No newline at end of file
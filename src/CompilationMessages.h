@@ -4,6 +4,7 @@
 #include <string>
 #include "CodeLoc.h"
 #include "reserved.h"
+#include "SourceManager.h"
 #include "SymbolTable.h"
 #include "Token.h"
 #include "TypeTable.h"
@@ -23,6 +24,7 @@ public:
 private:
     NamePool *namePool;
     StringPool *stringPool;
+    SourceManager *sourceManager;
     TypeTable *typeTable;
     SymbolTable *symbolTable;
     std::ostream *out;
@@ -48,8 +50,8 @@ private:
     std::string errorStringOfType(TypeTable::Id ty) const;
 
 public:
-    CompilationMessages(NamePool *namePool, StringPool *stringPool, TypeTable *typeTable, SymbolTable *symbolTable, std::ostream &out)
-        : namePool(namePool), stringPool(stringPool), typeTable(typeTable), symbolTable(symbolTable), out(&out), status(S_NONE) {}
+    CompilationMessages(NamePool *namePool, StringPool *stringPool, SourceManager *sourceManager, TypeTable *typeTable, SymbolTable *symbolTable, std::ostream &out)
+        : namePool(namePool), stringPool(stringPool), sourceManager(sourceManager), typeTable(typeTable), symbolTable(symbolTable), out(&out), status(S_NONE) {}
 
     Status getStatus() const {return status; }
     bool isFail() const { return status >= S_ERROR; }
@@ -86,6 +88,7 @@ public:
     void warnMacroArgTyped(CodeLoc loc);
 
     void errorInputFileNotFound(const std::string &path);
+    void errorFileNotWritten(const std::string &path);
     void errorBadToken(CodeLoc loc);
     void errorBadLiteral(CodeLoc loc);
     void errorUnclosedMultilineComment(CodeLoc loc);
@@ -159,6 +162,7 @@ public:
     void errorFuncCollisionNoNameMangle(CodeLoc loc, NamePool::Id name, CodeLoc codeLocOther);
     void errorFuncCollision(CodeLoc loc, NamePool::Id name, CodeLoc codeLocOther);
     void errorFuncNotEvalOrCompiled(CodeLoc loc);
+    void errorFuncConflictingAttrs(CodeLoc loc, const std::string &attr0, const std::string &attr1);
     void errorMacroNameTaken(CodeLoc loc, NamePool::Id name);
     void errorMacroTypeBadArgNumber(CodeLoc loc);
     void errorMacroArgAfterVariadic(CodeLoc loc);
@@ -166,6 +170,7 @@ public:
     void errorMacroCollision(CodeLoc loc, NamePool::Id name, CodeLoc codeLocOther);
     void errorMacroCollisionVariadic(CodeLoc loc, NamePool::Id name, CodeLoc codeLocOther);
     void errorArgNameDuplicate(CodeLoc loc, NamePool::Id name);
+    void errorArgNoAliasNonPointer(CodeLoc loc);
     void errorFuncNotFound(CodeLoc loc, std::vector<TypeTable::Id> argTys, std::optional<NamePool::Id> name = std::nullopt);
     void errorFuncNotFound(CodeLoc loc, NamePool::Id name, TypeTable::Id ty);
     void errorFuncNoDef(CodeLoc loc);
@@ -175,6 +180,9 @@ public:
     void errorMacroNoValue(CodeLoc loc);
     void errorDataCnElement(CodeLoc loc);
     void errorDataRedefinition(CodeLoc loc, NamePool::Id name);
+    void errorDataBadAlignment(CodeLoc loc);
+    void errorDataPackedAligned(CodeLoc loc);
+    void errorDataAlignmentUnsupported(CodeLoc loc, std::uint64_t alignment);
     void errorBlockBareNameType(CodeLoc loc);
     void errorBlockNotFound(CodeLoc loc, NamePool::Id name);
     void errorBlockNoPass(CodeLoc loc);
@@ -206,4 +214,5 @@ public:
     // placeholder error, should not stay in code
     void errorUnknown(CodeLoc loc);
     void errorInternal(CodeLoc loc);
+    void errorInternalBadCode(const std::string &funcName);
 };
\ No newline at end of file
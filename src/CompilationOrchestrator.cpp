@@ -1,9 +1,16 @@
 #include "CompilationOrchestrator.h"
 #include <filesystem>
+#include <fstream>
+#include <sstream>
 #include <stack>
 #include <unordered_map>
+#include <unordered_set>
+#include "llvm/ADT/SmallString.h"
+#include "llvm/Support/FileSystem.h"
+#include "llvm/Support/xxhash.h"
 #include "ClangAdapter.h"
-#include "Lexer.h"
+#include "ImportLocator.h"
+#include "ImportPrefetcher.h"
 #include "OrbCompilerConfig.h"
 #include "Parser.h"
 #include "reserved.h"
@@ -13,11 +20,12 @@ using namespace std;
 CompilationOrchestrator::CompilationOrchestrator(ProgramArgs programArgs, ostream &out) : args(move(programArgs)) {
     namePool = make_unique<NamePool>();
     stringPool = make_unique<StringPool>();
-    typeTable = make_unique<TypeTable>();
+    sourceManager = make_unique<SourceManager>();
+    typeTable = make_unique<TypeTable>(namePool.get());
     symbolTable = make_unique<SymbolTable>();
-    msgs = make_unique<CompilationMessages>(namePool.get(), stringPool.get(), typeTable.get(), symbolTable.get(), out);
+    msgs = make_unique<CompilationMessages>(namePool.get(), stringPool.get(), sourceManager.get(), typeTable.get(), symbolTable.get(), out);
     evaluator = make_unique<Evaluator>(namePool.get(), stringPool.get(), typeTable.get(), symbolTable.get(), msgs.get());
-    compiler = make_unique<Compiler>(namePool.get(), stringPool.get(), typeTable.get(), symbolTable.get(), msgs.get(), args);
+    compiler = make_unique<Compiler>(namePool.get(), stringPool.get(), sourceManager.get(), typeTable.get(), symbolTable.get(), msgs.get(), args);
     evaluator->setCompiler(compiler.get());
     compiler->setEvaluator(evaluator.get());
 
@@ -27,22 +35,22 @@ CompilationOrchestrator::CompilationOrchestrator(ProgramArgs programArgs, ostrea
 
 static void addMain(NamePool *namePool) {
     NamePool::Id name = namePool->addMain("main");
-    meaningfuls.insert(make_pair(name, Meaningful::MAIN));
+    setMeaningful(name, Meaningful::MAIN, namePool);
 }
 
 static void addMeaningful(NamePool *namePool, const std::string &str, Meaningful m) {
     NamePool::Id name = namePool->add(str);
-    meaningfuls.insert(make_pair(name, m));
+    setMeaningful(name, m, namePool);
 }
 
 static void addKeyword(NamePool *namePool, const std::string &str, Keyword k) {
     NamePool::Id name = namePool->add(str);
-    keywords.insert(make_pair(name, k));
+    setKeyword(name, k, namePool);
 }
 
 static void addOper(NamePool *namePool, const std::string &str, Oper o) {
     NamePool::Id name = namePool->add(str);
-    opers.insert(make_pair(name, o));
+    setOper(name, o, namePool);
 }
 
 void CompilationOrchestrator::genReserved() {
@@ -194,69 +202,188 @@ enum ImportTransRes {
     ITR_FAIL
 };
 
-static optional<string> locateOrbFile(const string &file, const vector<string> &additionalImportPaths) {
-    if (filesystem::exists(file)) return filesystem::canonical(file).string();
+static const string interfaceExt = ".orbi";
+static const string interfaceSourcePrefix = "# source: ";
 
-    for (const string &path : additionalImportPaths) {
-        filesystem::path importFile = filesystem::path(path) / file;
-        if (filesystem::exists(importFile)) return filesystem::canonical(importFile).string();
+// interfaces of the objects being linked, by the sources they were written from
+static unordered_map<string, string> findLinkedInterfaces(const vector<string> &objFiles, ImportLocator &importLocator) {
+    unordered_map<string, string> interfaces;
+
+    for (const string &obj : objFiles) {
+        filesystem::path pathInterface = filesystem::path(obj).replace_extension(interfaceExt);
+
+        ifstream in(pathInterface);
+        if (!in.is_open()) continue;
+
+        // sources are listed in the leading comments
+        for (string line; getline(in, line) && line.rfind("#", 0) == 0;) {
+            if (line.rfind(interfaceSourcePrefix, 0) != 0) continue;
+
+            string pathSrc = importLocator.identify(line.substr(interfaceSourcePrefix.size()));
+            interfaces.insert(make_pair(pathSrc, importLocator.identify(pathInterface)));
+        }
     }
 
-    {
-        filesystem::path libFile = filesystem::path(ORBC_LIBS_PATH) / file;
-        if (filesystem::exists(libFile)) return filesystem::canonical(libFile).string();
+    return interfaces;
+}
+
+// prefers the interface of the file, if its object is being linked and it was compiled since the last change of the file
+static optional<string> locateOrbImport(
+    const string &file, ImportLocator &importLocator, const unordered_map<string, string> &interfaces) {
+    optional<string> path = importLocator.locate(file);
+    if (!path.has_value()) return path;
+
+    auto loc = interfaces.find(path.value());
+    if (loc == interfaces.end()) return path;
+
+    error_code errorCodeSrc, errorCodeInterface;
+    filesystem::file_time_type timeSrc = filesystem::last_write_time(path.value(), errorCodeSrc);
+    filesystem::file_time_type timeInterface = filesystem::last_write_time(loc->second, errorCodeInterface);
+    if (errorCodeSrc || errorCodeInterface || timeInterface < timeSrc) return path;
+
+    return loc->second;
+}
+
+// top-level imports of literal files, which are very likely to be followed once reached
+static vector<string> findLiteralImports(const TokenBuffer &tokens, const NamePool *namePool, const StringPool *stringPool) {
+    vector<string> files;
+
+    size_t depth = 0;
+    bool atStart = true;
+    for (size_t i = 0; i+1 < tokens.size(); ++i) {
+        Token::Type type = tokens.getType(i);
+
+        if (depth == 0 && atStart && type == Token::T_ID && tokens.getType(i+1) == Token::T_STRING &&
+            isKeyword(tokens.get(i).nameId, Keyword::IMPORT, namePool)) {
+            files.push_back(stringPool->get(tokens.get(i+1).stringId));
+        }
+
+        if (type == Token::T_BRACE_L_REG || type == Token::T_BRACE_L_CUR) ++depth;
+        else if ((type == Token::T_BRACE_R_REG || type == Token::T_BRACE_R_CUR) && depth > 0) --depth;
+        atStart = depth == 0 && (type == Token::T_SEMICOLON || type == Token::T_BRACE_R_CUR);
     }
 
-    return nullopt;
+    return files;
 }
 
 static ImportTransRes followImport(
-    const string &path, Parser &par, NamePool *names, StringPool *strings, CompilationMessages *msgs,
-    unordered_map<string, unique_ptr<Lexer>> &lexers) {
-    auto loc = lexers.find(path);
-    if (loc == lexers.end()) {
-        unique_ptr<Lexer> lex = make_unique<Lexer>(names, strings, msgs, path);
-        if (!lex->start()) return ITR_FAIL;
-
-        par.setLexer(lex.get());
-        lexers.insert(make_pair(path, move(lex)));
+    const string &path, Parser &par, ImportPrefetcher &prefetcher, Compiler *compiler,
+    unordered_map<string, unique_ptr<TokenCursor>> &cursors) {
+    auto loc = cursors.find(path);
+    if (loc == cursors.end()) {
+        const TokenBuffer *tokens = prefetcher.load(path);
+        if (tokens == nullptr) return ITR_FAIL;
+
+        if (filesystem::path(path).extension().string() == interfaceExt) compiler->addInterfaceFile(tokens->getFile());
+
+        unique_ptr<TokenCursor> cursor = make_unique<TokenCursor>(TokenCursor{tokens});
+        par.start(cursor.get());
+        cursors.insert(make_pair(path, move(cursor)));
         return ITR_STARTED;
     } else {
-        par.setLexer(loc->second.get());
+        par.setCursor(loc->second.get());
 
         if (par.isOver()) return ITR_COMPLETED;
         else return ITR_CYCLICAL;
     }
 }
 
+// lexes the files the newly started one will likely import, while it is being processed
+static void prefetchImports(
+    const TokenBuffer &tokens, const NamePool *namePool, const StringPool *stringPool,
+    ImportLocator &importLocator, const unordered_map<string, string> &interfaces,
+    ImportPrefetcher &prefetcher, const unordered_map<string, unique_ptr<TokenCursor>> &cursors) {
+    for (const string &file : findLiteralImports(tokens, namePool, stringPool)) {
+        optional<string> path = locateOrbImport(file, importLocator, interfaces);
+        if (path.has_value() && cursors.find(path.value()) == cursors.end()) prefetcher.prefetch(path.value());
+    }
+}
+
+struct InterfaceEntry {
+    CodeLoc codeLoc;
+    // set for function definitions whose body is left out
+    optional<CodeOffset> bodyStart;
+};
+
+static bool isCompiledFuncDef(const NodeVal &node, const NodeVal &val, const NamePool *namePool, const TypeTable *typeTable) {
+    if (NodeVal::isLeaf(node, typeTable) || node.getChildrenCnt() != 5) return false;
+
+    const NodeVal &starting = node.getChild(0);
+    if (!starting.isLiteralVal() || starting.getLiteralVal().kind != LiteralVal::Kind::kId ||
+        !isKeyword(starting.getLiteralVal().val_id, Keyword::FNC, namePool)) {
+        return false;
+    }
+
+    // evaluable functions need their bodies in the interface
+    return val.isLlvmVal();
+}
+
+static bool writeInterface(
+    const string &filename, const vector<string> &sources, const vector<InterfaceEntry> &entries,
+    const SourceManager *sourceManager) {
+    ofstream out(filename);
+    if (!out.is_open()) return false;
+
+    out << "# Generated by orbc, do not edit." << endl;
+    for (const string &src : sources) out << interfaceSourcePrefix << src << endl;
+    out << endl;
+
+    for (const InterfaceEntry &entry : entries) {
+        const SourceFile *src = sourceManager->find(entry.codeLoc);
+        if (src == nullptr) return false;
+
+        if (entry.bodyStart.has_value()) {
+            string_view decl = src->getCode(CodeLoc::make(entry.codeLoc.start, entry.bodyStart.value()));
+            decl = decl.substr(0, decl.find_last_not_of(" \t\r\n")+1);
+            out << decl << ";" << endl << endl;
+        } else {
+            string_view code = src->getCode(entry.codeLoc);
+            out << code;
+            if (code.empty() || code.back() != '\n') out << endl;
+        }
+    }
+
+    return out.good();
+}
+
 bool CompilationOrchestrator::process() {
     if (args.inputsSrc.empty()) return true;
 
     Parser par(stringPool.get(), typeTable.get(), msgs.get());
+    ImportLocator importLocator(args.importPaths);
+    unordered_map<string, string> interfaces = findLinkedInterfaces(args.inputsOther, importLocator);
+    ImportPrefetcher prefetcher(namePool.get(), stringPool.get(), sourceManager.get(), args.importWorkerCnt);
 
-    unordered_map<string, unique_ptr<Lexer>> lexers;
-    stack<Lexer*> trace;
+    unordered_map<string, unique_ptr<TokenCursor>> cursors;
+    stack<TokenCursor*> trace;
+    vector<string> interfaceSources;
+    vector<InterfaceEntry> interfaceEntries;
 
     for (const string &in : args.inputsSrc) {
-        optional<string> pathOpt = locateOrbFile(in, args.importPaths);
+        optional<string> pathOpt = importLocator.locate(in);
         if (!pathOpt.has_value()) {
             msgs->errorInputFileNotFound(in);
             return false;
         }
         const string &path = pathOpt.value();
+        resolvedFiles.push_back(ResolvedFile{false, in, path});
 
-        ImportTransRes imres = followImport(path, par, namePool.get(), stringPool.get(), msgs.get(), lexers);
+        ImportTransRes imres = followImport(path, par, prefetcher, compiler.get(), cursors);
         if (imres == ITR_CYCLICAL || imres == ITR_FAIL) {
             // cyclical should logically not happen here
             return false;
         } else if (imres == ITR_COMPLETED) {
             continue;
         } else {
-            trace.push(par.getLexer());
+            trace.push(par.getCursor());
+            depFiles.push_back(path);
+            interfaceSources.push_back(path);
+            prefetchImports(*par.getCursor()->tokens, namePool.get(), stringPool.get(), importLocator, interfaces, prefetcher, cursors);
         }
+        TokenCursor *inputCursor = par.getCursor();
 
         while (!trace.empty()) {
-            par.setLexer(trace.top());
+            par.setCursor(trace.top());
 
             while (true) {
                 if (par.isOver()) {
@@ -264,22 +391,30 @@ bool CompilationOrchestrator::process() {
                     break;
                 }
 
-                NodeVal node = par.parseNode();
+                NodeVal node = par.parseTopmost();
                 if (msgs->isFail()) return false;
 
                 NodeVal val = compiler->processNode(node, true);
                 if (msgs->isFail()) return false;
 
+                if (args.outputInterface.has_value() && par.getCursor() == inputCursor) {
+                    InterfaceEntry entry;
+                    entry.codeLoc = node.getCodeLoc();
+                    if (isCompiledFuncDef(node, val, namePool.get(), typeTable.get())) entry.bodyStart = node.getChild(4).getCodeLoc().start;
+                    interfaceEntries.push_back(entry);
+                }
+
                 if (val.isImport()) {
                     const string &file = stringPool->get(val.getImportFile());
-                    optional<string> pathOpt = locateOrbFile(file, args.importPaths);
+                    optional<string> pathOpt = locateOrbImport(file, importLocator, interfaces);
                     if (!pathOpt.has_value()) {
                         msgs->errorImportNotFound(node.getCodeLoc(), file);
                         return false;
                     }
                     const string &path = pathOpt.value();
+                    resolvedFiles.push_back(ResolvedFile{true, file, path});
 
-                    ImportTransRes imres = followImport(path, par, namePool.get(), stringPool.get(), msgs.get(), lexers);
+                    ImportTransRes imres = followImport(path, par, prefetcher, compiler.get(), cursors);
                     if (imres == ITR_FAIL) {
                         return false;
                     } else if (imres == ITR_CYCLICAL) {
@@ -288,7 +423,15 @@ bool CompilationOrchestrator::process() {
                     }
 
                     if (imres == ITR_STARTED) {
-                        trace.push(par.getLexer());
+                        trace.push(par.getCursor());
+                        depFiles.push_back(path);
+                        prefetchImports(*par.getCursor()->tokens, namePool.get(), stringPool.get(), importLocator, interfaces, prefetcher, cursors);
+
+                        // the source gets imported instead once it is changed
+                        if (filesystem::path(path).extension().string() == interfaceExt) {
+                            optional<string> pathSrc = importLocator.locate(file);
+                            if (pathSrc.has_value()) depFiles.push_back(pathSrc.value());
+                        }
                     }
                     break;
                 }
@@ -296,6 +439,12 @@ bool CompilationOrchestrator::process() {
         }
     }
 
+    if (args.outputInterface.has_value() &&
+        !writeInterface(args.outputInterface.value(), interfaceSources, interfaceEntries, sourceManager.get())) {
+        msgs->errorFileNotWritten(args.outputInterface.value());
+        return false;
+    }
+
     return true;
 }
 
@@ -303,6 +452,9 @@ void CompilationOrchestrator::printout() const {
     if (args.outputLlvm.has_value()) {
         compiler->printout(args.outputLlvm.value());
     }
+    if (args.outputBc.has_value()) {
+        compiler->printoutBc(args.outputBc.value());
+    }
 }
 
 bool CompilationOrchestrator::compile() {
@@ -318,19 +470,179 @@ bool CompilationOrchestrator::compile() {
             return false;
         }
 
-        const static string tempObjName = PLATFORM_WINDOWS ? "a.obj" : "a.o";
+        if (args.codegenCache.has_value()) {
+            vector<string> objFiles;
+            if (!compiler->binaryCached(args.codegenCache.value(), objFiles)) return false;
+
+            return buildExecutable(args, objFiles);
+        }
+
+        // kept out of the way of the user's files, which may include an object of the same name
+        llvm::SmallString<128> tempObjPath;
+        if (llvm::sys::fs::createTemporaryFile("orbc", PLATFORM_WINDOWS ? "obj" : "o", tempObjPath)) {
+            error_code errorCode;
+            msgs->errorFileNotWritten(filesystem::temp_directory_path(errorCode).string());
+            return false;
+        }
+        string tempObjName = tempObjPath.str().str();
 
-        if (!compiler->binary(tempObjName)) return false;
+        if (!compiler->binary(tempObjName)) {
+            remove(tempObjName.c_str());
+            return false;
+        }
 
-        bool success = buildExecutable(args, tempObjName);
+        bool success = buildExecutable(args, {tempObjName});
 
         remove(tempObjName.c_str());
         return success;
     } else {
-        return buildExecutable(args, "");
+        return buildExecutable(args, {});
     }
 }
 
+static string escapeForMakefile(const string &path) {
+    string escaped;
+    // backslashes are only special right before an escaped character, they are doubled there so they escape each other
+    auto doubleBackslashesBefore = [&](size_t ind) {
+        for (size_t i = ind; i > 0 && path[i-1] == '\\'; --i) escaped += '\\';
+    };
+
+    for (size_t i = 0; i < path.size(); ++i) {
+        char c = path[i];
+        if (c == ' ' || c == '#' || c == ':') {
+            doubleBackslashesBefore(i);
+            escaped += '\\';
+        } else if (c == '$') {
+            escaped += '$';
+        }
+        escaped += c;
+    }
+    // the separator that follows counts too
+    doubleBackslashesBefore(path.size());
+
+    return escaped;
+}
+
+static string getDepsManifestPath(const ProgramArgs &args) {
+    return args.outputBin + ".orbdeps";
+}
+
+static const string manifestInputPrefix = "input ";
+static const string manifestImportPrefix = "import ";
+
+static optional<uint64_t> hashFileContents(const string &path) {
+    ifstream in(path, ios::binary);
+    if (!in.is_open()) return nullopt;
+
+    string contents((istreambuf_iterator<char>(in)), istreambuf_iterator<char>());
+    return llvm::xxHash64(contents);
+}
+
+bool CompilationOrchestrator::printoutDeps() const {
+    // a file may be reached through several imports
+    vector<string> deps;
+    unordered_set<string> depsSeen;
+    for (const string &dep : depFiles) {
+        if (depsSeen.insert(dep).second) deps.push_back(dep);
+    }
+    for (const string &dep : args.inputsOther) {
+        if (depsSeen.insert(dep).second) deps.push_back(dep);
+    }
+
+    if (args.outputDeps.has_value()) {
+        ofstream out(args.outputDeps.value());
+
+        out << escapeForMakefile(args.outputBin) << ":";
+        for (const string &dep : deps) out << " \\" << endl << "  " << escapeForMakefile(dep);
+        out << endl;
+
+        if (!out.good()) {
+            msgs->errorFileNotWritten(args.outputDeps.value());
+            return false;
+        }
+    }
+
+    if (args.skipIfUpToDate) {
+        // first line identifies the arguments, then come content hashes of dependencies followed by their paths,
+        // then how inputs and imports were resolved, each as "input <file>" or "import <file>" with the path on the next line
+        stringstream manifest;
+
+        manifest << llvm::xxHash64(args.invocation) << endl;
+        for (const string &dep : deps) {
+            optional<uint64_t> hash = hashFileContents(dep);
+            if (!hash.has_value()) {
+                // an incomplete manifest could wrongly tell the output is up to date, without one it is compiled again
+                error_code errorCode;
+                filesystem::remove(getDepsManifestPath(args), errorCode);
+                return true;
+            }
+
+            manifest << hash.value() << " " << dep << endl;
+        }
+
+        // a file added since then could be found first
+        unordered_set<string> resolvedSeen;
+        for (const ResolvedFile &resolved : resolvedFiles) {
+            string line = (resolved.isImport ? manifestImportPrefix : manifestInputPrefix) + resolved.file;
+            if (resolvedSeen.insert(line).second) manifest << line << endl << resolved.path << endl;
+        }
+
+        ofstream out(getDepsManifestPath(args));
+        out << manifest.str();
+
+        if (!out.good()) {
+            msgs->errorFileNotWritten(getDepsManifestPath(args));
+            return false;
+        }
+    }
+
+    return true;
+}
+
+bool CompilationOrchestrator::isUpToDate(const ProgramArgs &args) {
+    error_code errorCode;
+    filesystem::file_time_type outputTime = filesystem::last_write_time(args.outputBin, errorCode);
+    if (errorCode) return false;
+
+    ifstream in(getDepsManifestPath(args));
+    if (!in.is_open()) return false;
+
+    string line;
+    if (!getline(in, line) || line != to_string(llvm::xxHash64(args.invocation))) return false;
+
+    ImportLocator importLocator(args.importPaths);
+    unordered_map<string, string> interfaces = findLinkedInterfaces(args.inputsOther, importLocator);
+
+    while (getline(in, line)) {
+        bool isInput = line.rfind(manifestInputPrefix, 0) == 0, isImport = line.rfind(manifestImportPrefix, 0) == 0;
+        if (isInput || isImport) {
+            string pathPrev;
+            if (!getline(in, pathPrev)) return false;
+
+            optional<string> path;
+            if (isInput) path = importLocator.locate(line.substr(manifestInputPrefix.size()));
+            else path = locateOrbImport(line.substr(manifestImportPrefix.size()), importLocator, interfaces);
+            if (path != pathPrev) return false;
+
+            continue;
+        }
+
+        size_t sep = line.find(' ');
+        if (sep == string::npos) return false;
+        string path = line.substr(sep+1);
+
+        filesystem::file_time_type time = filesystem::last_write_time(path, errorCode);
+        if (errorCode) return false;
+        if (time <= outputTime) continue;
+
+        // only touched files do not need recompiling
+        optional<uint64_t> hash = hashFileContents(path);
+        if (!hash.has_value() || to_string(hash.value()) != line.substr(0, sep)) return false;
+    }
+
+    return true;
+}
+
 bool CompilationOrchestrator::isInternalError() const {
     return msgs->getStatus() == CompilationMessages::S_INTERNAL;
 }
\ No newline at end of file
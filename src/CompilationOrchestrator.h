@@ -8,17 +8,30 @@
 #include "Compiler.h"
 #include "Evaluator.h"
 #include "ProgramArgs.h"
+#include "SourceManager.h"
 #include "SymbolTable.h"
 
 class CompilationOrchestrator {
     ProgramArgs args;
     std::unique_ptr<NamePool> namePool;
     std::unique_ptr<StringPool> stringPool;
+    std::unique_ptr<SourceManager> sourceManager;
     std::unique_ptr<TypeTable> typeTable;
     std::unique_ptr<SymbolTable> symbolTable;
     std::unique_ptr<CompilationMessages> msgs;
     std::unique_ptr<Compiler> compiler;
     std::unique_ptr<Evaluator> evaluator;
+    // all files read when processing, in order
+    std::vector<std::string> depFiles;
+
+    struct ResolvedFile {
+        bool isImport;
+        // as given in the arguments or the import
+        std::string file;
+        std::string path;
+    };
+    // where the inputs and imports were found, in order
+    std::vector<ResolvedFile> resolvedFiles;
 
     void genReserved();
     void genPrimTypes();
@@ -29,6 +42,9 @@ public:
     bool process();
     void printout() const;
     bool compile();
+    bool printoutDeps() const;
+
+    static bool isUpToDate(const ProgramArgs &args);
 
     bool isInternalError() const;
 };
\ No newline at end of file
@@ -1,29 +1,76 @@
 #include "Compiler.h"
+#include <filesystem>
+#include <functional>
 #include <iostream>
 #include <sstream>
+#include "llvm/ADT/StringExtras.h"
+#include "llvm/Bitcode/BitcodeWriter.h"
+#include "llvm/Bitcode/BitcodeWriterPass.h"
+#include "llvm/IR/Operator.h"
 #include "llvm/IR/Verifier.h"
 #include "llvm/Support/FileSystem.h"
 #include "llvm/Support/Host.h"
+#include "llvm/Support/Path.h"
 #include "llvm/Support/raw_ostream.h"
+#include "llvm/Support/SHA1.h"
 #include "llvm/Support/TargetRegistry.h"
 #include "llvm/Support/TargetSelect.h"
 #include "llvm/Target/TargetMachine.h"
 #include "llvm/Target/TargetOptions.h"
+#include "llvm/Transforms/IPO.h"
+#include "llvm/Transforms/IPO/AlwaysInliner.h"
+#include "llvm/Transforms/Utils/Cloning.h"
+#include "llvm/Transforms/Utils/ValueMapper.h"
 #include "BlockRaii.h"
 using namespace std;
 
-Compiler::Compiler(NamePool *namePool, StringPool *stringPool, TypeTable *typeTable, SymbolTable *symbolTable, CompilationMessages *msgs, const ProgramArgs &args)
-    : Processor(namePool, stringPool, typeTable, symbolTable, msgs), llvmBuilder(llvmContext), llvmBuilderAlloca(llvmContext), targetMachine(nullptr) {
+Compiler::Compiler(NamePool *namePool, StringPool *stringPool, SourceManager *sourceManager, TypeTable *typeTable, SymbolTable *symbolTable, CompilationMessages *msgs, const ProgramArgs &args)
+    : Processor(namePool, stringPool, typeTable, symbolTable, msgs), sourceManager(sourceManager), llvmBuilder(llvmContext), llvmBuilderAlloca(llvmContext), targetMachine(nullptr) {
     setCompiler(this);
 
     llvmModule = std::make_unique<llvm::Module>(llvm::StringRef("module"), llvmContext);
+    // profiles identify private functions by this name
+    if (!args.inputsSrc.empty()) llvmModule->setSourceFileName(args.inputsSrc.front());
 
     llvmPmb = make_unique<llvm::PassManagerBuilder>();
     if (args.optLvl.has_value()) llvmPmb->OptLevel = args.optLvl.value();
+    if (args.profileGenerate) {
+        llvmPmb->EnablePGOInstrGen = true;
+        // same default as clang, %m distinguishes between binaries
+        llvmPmb->PGOInstrGen = "default_%m.profraw";
+    }
+    if (args.profileUse.has_value()) llvmPmb->PGOInstrUse = args.profileUse.value();
+    // leaves out passes that are better done on the whole program when linking
+    llvmPmb->PrepareForThinLTO = args.lto == ProgramArgs::LTO_THIN;
+    llvmPmb->PrepareForLTO = args.lto == ProgramArgs::LTO_FULL;
+    // same as clang, only inline functions marked inline on low opt levels
+    if (llvmPmb->OptLevel <= 1) llvmPmb->Inliner = llvm::createAlwaysInlinerLegacyPass();
+    else llvmPmb->Inliner = llvm::createFunctionInliningPass(llvmPmb->OptLevel, llvmPmb->SizeLevel, false);
     llvmFpm = make_unique<llvm::legacy::FunctionPassManager>(llvmModule.get());
     llvmPmb->populateFunctionPassManager(*llvmFpm);
 
     link = args.link;
+    emitInterface = args.outputInterface.has_value();
+    fastMathAll = args.fastMath;
+    lto = args.lto;
+    // the summary needs to tell linkers to merge this module, as opposed to importing from it
+    if (lto == ProgramArgs::LTO_FULL) llvmModule->addModuleFlag(llvm::Module::Error, "ThinLTO", 0u);
+
+    if (args.debugInfo != ProgramArgs::DI_NONE && !args.inputsSrc.empty()) {
+        llvmDiBuilder = make_unique<llvm::DIBuilder>(*llvmModule);
+
+        filesystem::path mainPath = filesystem::absolute(args.inputsSrc.front());
+        llvmDiCompileUnit = llvmDiBuilder->createCompileUnit(
+            llvm::dwarf::DW_LANG_C,
+            llvmDiBuilder->createFile(mainPath.filename().string(), mainPath.parent_path().string()),
+            "orbc", llvmPmb->OptLevel > 0, "", 0, "",
+            args.debugInfo == ProgramArgs::DI_FULL ? llvm::DICompileUnit::FullDebug : llvm::DICompileUnit::LineTablesOnly);
+
+        llvmModule->addModuleFlag(llvm::Module::Warning, "Debug Info Version", llvm::DEBUG_METADATA_VERSION);
+        llvmModule->addModuleFlag(llvm::Module::Warning, "Dwarf Version", 4);
+
+        debugInfoFull = args.debugInfo == ProgramArgs::DI_FULL;
+    }
 }
 
 void Compiler::printout(const std::string &filename) const {
@@ -37,11 +84,25 @@ void Compiler::printout(const std::string &filename) const {
     llvmModule->print(dest, nullptr);
 }
 
+void Compiler::printoutBc(const std::string &filename) const {
+    std::error_code errorCode;
+    llvm::raw_fd_ostream dest(filename, errorCode, llvm::sys::fs::F_None);
+    if (errorCode) {
+        llvm::errs() << "Could not open file: " << errorCode.message();
+        return;
+    }
+
+    llvm::WriteBitcodeToFile(*llvmModule, dest);
+}
+
 bool Compiler::binary(const std::string &filename) {
     if (targetMachine == nullptr && !initLlvmTargetMachine()) {
         return false;
     }
 
+    if (llvmDiBuilder != nullptr) llvmDiBuilder->finalize();
+    if (!runLlvmFunctionPasses()) return false;
+
     std::error_code errorCode;
     llvm::raw_fd_ostream dest(filename, errorCode, llvm::sys::fs::F_None);
     if (errorCode) {
@@ -52,12 +113,18 @@ bool Compiler::binary(const std::string &filename) {
     llvm::legacy::PassManager llvmPm;
     llvmPmb->populateModulePassManager(llvmPm);
 
-    llvm::CodeGenFileType fileType = llvm::CGFT_ObjectFile;
+    if (lto == ProgramArgs::LTO_THIN) {
+        llvmPm.add(llvm::createWriteThinLTOBitcodePass(dest));
+    } else if (lto == ProgramArgs::LTO_FULL) {
+        llvmPm.add(llvm::createBitcodeWriterPass(dest, false, true));
+    } else {
+        llvm::CodeGenFileType fileType = llvm::CGFT_ObjectFile;
 
-    bool failed = targetMachine->addPassesToEmitFile(llvmPm, dest, nullptr, fileType);
-    if (failed) {
-        llvm::errs() << "Target machine can't emit to this file type!";
-        return false;
+        bool failed = targetMachine->addPassesToEmitFile(llvmPm, dest, nullptr, fileType);
+        if (failed) {
+            llvm::errs() << "Target machine can't emit to this file type!";
+            return false;
+        }
     }
 
     llvmPm.run(*llvmModule);
@@ -66,6 +133,213 @@ bool Compiler::binary(const std::string &filename) {
     return true;
 }
 
+// declares the globals a piece of a split module refers to, but does not define itself
+struct LlvmPieceDeclarer : public llvm::ValueMaterializer {
+    llvm::Module *llvmPiece;
+
+    explicit LlvmPieceDeclarer(llvm::Module *llvmPiece) : llvmPiece(llvmPiece) {}
+
+    llvm::Value* materialize(llvm::Value *llvmVal) override {
+        if (llvm::Function *llvmFunc = llvm::dyn_cast<llvm::Function>(llvmVal)) {
+            llvm::Function *llvmDecl = llvm::Function::Create(
+                llvmFunc->getFunctionType(), llvm::GlobalValue::ExternalLinkage, llvmFunc->getAddressSpace(), llvmFunc->getName(), llvmPiece);
+            llvmDecl->copyAttributesFrom(llvmFunc);
+            // not valid on a declaration
+            llvmDecl->setPersonalityFn(nullptr);
+            return llvmDecl;
+        }
+
+        if (llvm::GlobalVariable *llvmVar = llvm::dyn_cast<llvm::GlobalVariable>(llvmVal)) {
+            llvm::GlobalVariable *llvmDecl = new llvm::GlobalVariable(
+                *llvmPiece, llvmVar->getValueType(), llvmVar->isConstant(), llvm::GlobalValue::ExternalLinkage,
+                nullptr, llvmVar->getName(), nullptr, llvmVar->getThreadLocalMode(), llvmVar->getAddressSpace());
+            llvmDecl->copyAttributesFrom(llvmVar);
+            return llvmDecl;
+        }
+
+        return nullptr;
+    }
+};
+
+static std::unique_ptr<llvm::Module> makeLlvmPiece(const llvm::Module &llvmModule, llvm::ValueToValueMapTy &llvmValueMap) {
+    std::unique_ptr<llvm::Module> llvmPiece = std::make_unique<llvm::Module>(llvmModule.getModuleIdentifier(), llvmModule.getContext());
+    llvmPiece->setDataLayout(llvmModule.getDataLayout());
+    llvmPiece->setTargetTriple(llvmModule.getTargetTriple());
+    // so that the path of the input does not change the hash
+    llvmPiece->setSourceFileName("");
+
+    // compile units are shared rather than cloned into every piece
+    for (const llvm::DICompileUnit *llvmDiUnit : llvmModule.debug_compile_units()) {
+        llvmValueMap.MD()[llvmDiUnit].reset(const_cast<llvm::DICompileUnit*>(llvmDiUnit));
+    }
+    for (const llvm::NamedMDNode &llvmNamedMd : llvmModule.named_metadata()) {
+        llvm::NamedMDNode *llvmPieceNamedMd = llvmPiece->getOrInsertNamedMetadata(llvmNamedMd.getName());
+        for (const llvm::MDNode *llvmMd : llvmNamedMd.operands()) llvmPieceNamedMd->addOperand(llvm::MapMetadata(llvmMd, llvmValueMap));
+    }
+
+    return llvmPiece;
+}
+
+// each function gets its own piece, global variables all go in one
+// pieces only get declarations of what they refer to, so splitting takes time proportional to the size of the module
+static bool splitLlvmModule(const llvm::Module &llvmModule, const std::function<bool(std::unique_ptr<llvm::Module>)> &onPiece) {
+    bool hasGlobalVars = false;
+    for (const llvm::GlobalVariable &llvmGlobalVar : llvmModule.globals()) {
+        if (!llvmGlobalVar.isDeclaration()) hasGlobalVars = true;
+    }
+    if (hasGlobalVars) {
+        llvm::ValueToValueMapTy llvmValueMap;
+        std::unique_ptr<llvm::Module> llvmPiece = makeLlvmPiece(llvmModule, llvmValueMap);
+        LlvmPieceDeclarer llvmDeclarer(llvmPiece.get());
+
+        // defined before any initializers are mapped, as those may refer to each other
+        std::vector<std::pair<const llvm::GlobalVariable*, llvm::GlobalVariable*>> llvmVarDefs;
+        for (const llvm::GlobalVariable &llvmVar : llvmModule.globals()) {
+            if (llvmVar.isDeclaration()) continue;
+
+            llvm::GlobalVariable *llvmDef = new llvm::GlobalVariable(
+                *llvmPiece, llvmVar.getValueType(), llvmVar.isConstant(), llvmVar.getLinkage(),
+                nullptr, llvmVar.getName(), nullptr, llvmVar.getThreadLocalMode(), llvmVar.getAddressSpace());
+            llvmDef->copyAttributesFrom(&llvmVar);
+            llvmValueMap[&llvmVar] = llvmDef;
+            llvmVarDefs.emplace_back(&llvmVar, llvmDef);
+        }
+        for (const auto &[llvmVar, llvmDef] : llvmVarDefs) {
+            llvmDef->setInitializer(llvm::MapValue(llvmVar->getInitializer(), llvmValueMap, llvm::RF_None, nullptr, &llvmDeclarer));
+
+            llvm::SmallVector<std::pair<unsigned, llvm::MDNode*>, 1> llvmMds;
+            llvmVar->getAllMetadata(llvmMds);
+            for (const auto &[kind, llvmMd] : llvmMds) {
+                llvmDef->addMetadata(kind, *llvm::MapMetadata(llvmMd, llvmValueMap, llvm::RF_None, nullptr, &llvmDeclarer));
+            }
+        }
+
+        if (!onPiece(move(llvmPiece))) return false;
+    }
+
+    for (const llvm::Function &llvmFunc : llvmModule) {
+        if (llvmFunc.isDeclaration()) continue;
+
+        llvm::ValueToValueMapTy llvmValueMap;
+        std::unique_ptr<llvm::Module> llvmPiece = makeLlvmPiece(llvmModule, llvmValueMap);
+        LlvmPieceDeclarer llvmDeclarer(llvmPiece.get());
+
+        llvm::Function *llvmDef = llvm::Function::Create(
+            llvmFunc.getFunctionType(), llvmFunc.getLinkage(), llvmFunc.getAddressSpace(), llvmFunc.getName(), llvmPiece.get());
+        llvmDef->copyAttributesFrom(&llvmFunc);
+        llvmValueMap[&llvmFunc] = llvmDef;
+
+        auto llvmDefArg = llvmDef->arg_begin();
+        for (const llvm::Argument &llvmArg : llvmFunc.args()) {
+            llvmDefArg->setName(llvmArg.getName());
+            llvmValueMap[&llvmArg] = &*llvmDefArg++;
+        }
+
+        llvm::SmallVector<llvm::ReturnInst*, 8> llvmReturns;
+        llvm::CloneFunctionInto(
+            llvmDef, &llvmFunc, llvmValueMap, llvm::CloneFunctionChangeType::DifferentModule, llvmReturns,
+            "", nullptr, nullptr, &llvmDeclarer);
+
+        if (!onPiece(move(llvmPiece))) return false;
+    }
+
+    return true;
+}
+
+bool Compiler::binaryCached(const std::string &dir, std::vector<std::string> &objFiles) {
+    if (targetMachine == nullptr && !initLlvmTargetMachine()) {
+        return false;
+    }
+
+    if (llvmDiBuilder != nullptr) llvmDiBuilder->finalize();
+    if (!runLlvmFunctionPasses()) return false;
+
+    std::error_code errorCode = llvm::sys::fs::create_directories(dir);
+    if (errorCode) {
+        llvm::errs() << "Could not create directory: " << errorCode.message();
+        return false;
+    }
+
+    // functions are split after optimizing, so inlining etc. still happen across them
+    llvm::legacy::PassManager llvmPmOpt;
+    llvmPmb->populateModulePassManager(llvmPmOpt);
+    llvmPmOpt.run(*llvmModule);
+
+    // the pieces refer to each other's symbols, so none can stay local
+    std::unique_ptr<llvm::Module> llvmModuleSplit = llvm::CloneModule(*llvmModule);
+    for (llvm::GlobalValue &llvmGlobal : llvmModuleSplit->global_values()) {
+        if (!llvmGlobal.hasLocalLinkage()) continue;
+
+        llvmGlobal.setName("orb.cg." + llvmGlobal.getName());
+        llvmGlobal.setLinkage(llvm::GlobalValue::ExternalLinkage);
+        llvmGlobal.setVisibility(llvm::GlobalValue::HiddenVisibility);
+    }
+
+    std::size_t pieceCnt = 0, hits = 0;
+    bool success = splitLlvmModule(*llvmModuleSplit, [&](std::unique_ptr<llvm::Module> llvmPiece) {
+        ++pieceCnt;
+
+        // callees are declared in the IR, so their signatures are covered as well
+        std::string llvmIr;
+        llvm::raw_string_ostream llvmIrStream(llvmIr);
+        llvmPiece->print(llvmIrStream, nullptr);
+        llvmIrStream << targetMachine->getTargetTriple().str() << ' '
+            << targetMachine->getTargetCPU() << ' '
+            << targetMachine->getTargetFeatureString() << ' '
+            << llvmPmb->OptLevel << ' ' << llvmPmb->SizeLevel;
+        llvmIrStream.flush();
+
+        llvm::SmallString<128> path(dir);
+        llvm::sys::path::append(path, llvm::toHex(llvm::SHA1::hash(llvm::arrayRefFromStringRef(llvmIr)), true) + ".o");
+        objFiles.push_back(path.str().str());
+
+        if (llvm::sys::fs::exists(path)) {
+            ++hits;
+            return true;
+        }
+
+        // written under a temporary name first, so that interrupted compilations do not leave broken objects behind
+        int fd;
+        llvm::SmallString<128> pathTemp;
+        errorCode = llvm::sys::fs::createUniqueFile(path + ".%%%%%%.tmp", fd, pathTemp);
+        if (errorCode) {
+            llvm::errs() << "Could not open file: " << errorCode.message();
+            return false;
+        }
+
+        {
+            llvm::raw_fd_ostream dest(fd, true);
+
+            llvm::legacy::PassManager llvmPm;
+            bool failed = targetMachine->addPassesToEmitFile(llvmPm, dest, nullptr, llvm::CGFT_ObjectFile);
+            if (failed) {
+                llvm::errs() << "Target machine can't emit to this file type!";
+                llvm::sys::fs::remove(pathTemp);
+                return false;
+            }
+
+            llvmPm.run(*llvmPiece);
+        }
+
+        errorCode = llvm::sys::fs::rename(pathTemp, path);
+        if (errorCode) {
+            llvm::errs() << "Could not write file: " << errorCode.message();
+            llvm::sys::fs::remove(pathTemp);
+            return false;
+        }
+
+        return true;
+    });
+    if (!success) return false;
+
+    if (pieceCnt > 0) {
+        llvm::errs() << "Codegen cache: reused " << hits << " of " << pieceCnt << " objects ("
+            << hits*100/pieceCnt << "% hit rate).\n";
+    }
+
+    return true;
+}
+
 llvm::Type* Compiler::genPrimTypeBool() {
     return llvm::IntegerType::get(llvmContext, 1);
 }
@@ -96,6 +370,8 @@ llvm::Type* Compiler::genPrimTypePtr() {
 }
 
 NodeVal Compiler::performLoad(CodeLoc codeLoc, VarId varId) {
+    setLlvmDebugLoc(codeLoc);
+
     const SymbolTable::VarEntry &ref = symbolTable->getVar(varId);
 
     if (!checkInLocalScope(codeLoc, true)) {
@@ -106,9 +382,17 @@ NodeVal Compiler::performLoad(CodeLoc codeLoc, VarId varId) {
 
     LlvmVal loadLlvmVal(ref.var.getLlvmVal().type);
     loadLlvmVal.ref = ref.var.getLlvmVal().ref;
-    loadLlvmVal.varId = varId;
-    loadLlvmVal.lifetimeInfo = ref.var.getLlvmVal().lifetimeInfo;
-    loadLlvmVal.val = llvmBuilder.CreateLoad(ref.var.getLlvmVal().ref, getNameForLlvm(ref.name));
+    loadLlvmVal.refAlign = ref.var.getLlvmVal().refAlign;
+    loadLlvmVal.setVarId(varId);
+    loadLlvmVal.setLifetimeInfo(ref.var.getLlvmVal().getLifetimeInfo());
+    loadLlvmVal.val = makeLlvmLoad(loadLlvmVal.ref, getLlvmRefAlign(loadLlvmVal), getNameForLlvm(ref.name));
+
+    // the variable may get written to, so it needs to be dropped again
+    auto loc = llvmDropFlags.find(ref.var.getLlvmVal().ref);
+    if (loc != llvmDropFlags.end() && !loc->second.addrTaken) {
+        llvmBuilder.CreateStore(getLlvmConstB(true), loc->second.llvmFlag);
+    }
+
     return NodeVal(codeLoc, loadLlvmVal);
 }
 
@@ -117,9 +401,15 @@ NodeVal Compiler::performLoad(CodeLoc codeLoc, FuncId funcId) {
 
     if (!checkIsLlvmFunc(codeLoc, func, true)) return NodeVal();
 
+    llvm::Function *llvmFunc = getLlvmByRefAbiFunc(func);
+    if (llvmFunc == nullptr) {
+        msgs->errorTypeCannotCompile(codeLoc, func.getType());
+        return NodeVal();
+    }
+
     LlvmVal llvmVal;
     llvmVal.type = func.getType();
-    llvmVal.val = func.llvmFunc;
+    llvmVal.val = llvmFunc;
     return NodeVal(codeLoc, llvmVal);
 }
 
@@ -145,21 +435,29 @@ NodeVal Compiler::performZero(CodeLoc codeLoc, TypeTable::Id ty) {
 }
 
 NodeVal Compiler::performRegister(CodeLoc codeLoc, NamePool::Id id, CodeLoc codeLocTy, TypeTable::Id ty) {
+    setLlvmDebugLoc(codeLoc);
+
     llvm::Type *llvmType = makeLlvmTypeOrError(codeLocTy, ty);
     if (llvmType == nullptr) return NodeVal();
 
     LlvmVal llvmVal(ty);
     if (symbolTable->inGlobalScope()) {
-        llvmVal.ref = makeLlvmGlobal(llvmType, nullptr, typeTable->worksAsTypeCn(ty), getNameForLlvm(id));
+        llvmVal.ref = makeLlvmGlobalForVar(codeLoc, llvmType, nullptr, typeTable->worksAsTypeCn(ty), getNameForLlvm(id));
     } else {
         llvmVal.ref = makeLlvmAlloca(llvmType, getNameForLlvm(id));
+        if (!hasTrivialDrop(ty)) makeLlvmDropFlag(llvmVal.ref);
+        declareLlvmDebugVar(codeLoc, id, ty, llvmVal.ref, 0);
     }
-    llvmVal.lifetimeInfo.nestLevel = symbolTable->currNestLevel();
+    LifetimeInfo lifetimeInfo;
+    lifetimeInfo.nestLevel = symbolTable->currNestLevel();
+    llvmVal.setLifetimeInfo(lifetimeInfo);
 
     return NodeVal(codeLoc, llvmVal);
 }
 
 NodeVal Compiler::performRegister(CodeLoc codeLoc, NamePool::Id id, NodeVal init) {
+    setLlvmDebugLoc(codeLoc);
+
     NodeVal promo = promoteIfEvalValAndCheckIsLlvmVal(init, true);
     if (promo.isInvalid()) return NodeVal();
 
@@ -169,17 +467,23 @@ NodeVal Compiler::performRegister(CodeLoc codeLoc, NamePool::Id id, NodeVal init
 
     LlvmVal llvmVal(ty);
     if (symbolTable->inGlobalScope()) {
-        llvmVal.ref = makeLlvmGlobal(llvmType, (llvm::Constant*) promo.getLlvmVal().val, typeTable->worksAsTypeCn(ty), getNameForLlvm(id));
+        llvmVal.ref = makeLlvmGlobalForVar(codeLoc, llvmType, (llvm::Constant*) promo.getLlvmVal().val, typeTable->worksAsTypeCn(ty), getNameForLlvm(id));
     } else {
         llvmVal.ref = makeLlvmAlloca(llvmType, getNameForLlvm(id));
-        llvmBuilder.CreateStore(promo.getLlvmVal().val, llvmVal.ref);
+        makeLlvmStore(promo.getLlvmVal().val, llvmVal.ref, getLlvmRefAlign(llvmVal));
+        if (!hasTrivialDrop(ty)) makeLlvmDropFlag(llvmVal.ref);
+        declareLlvmDebugVar(codeLoc, id, ty, llvmVal.ref, 0);
     }
-    llvmVal.lifetimeInfo.nestLevel = symbolTable->currNestLevel();
+    LifetimeInfo lifetimeInfo;
+    lifetimeInfo.nestLevel = symbolTable->currNestLevel();
+    llvmVal.setLifetimeInfo(lifetimeInfo);
 
     return NodeVal(codeLoc, llvmVal);
 }
 
 NodeVal Compiler::performCast(CodeLoc codeLoc, const NodeVal &node, CodeLoc codeLocTy, TypeTable::Id ty) {
+    setLlvmDebugLoc(codeLoc);
+
     if (!checkInLocalScope(codeLoc, true)) return NodeVal();
 
     NodeVal promo = promoteIfEvalValAndCheckIsLlvmVal(node, true);
@@ -196,11 +500,15 @@ NodeVal Compiler::performCast(CodeLoc codeLoc, const NodeVal &node, CodeLoc code
 
     LlvmVal llvmVal(ty);
     llvmVal.val = llvmValueCast;
-    llvmVal.lifetimeInfo.noDrop = promo.isNoDrop() || node.hasRef();
+    LifetimeInfo lifetimeInfo;
+    lifetimeInfo.noDrop = promo.isNoDrop() || node.hasRef();
+    llvmVal.setLifetimeInfo(lifetimeInfo);
     return NodeVal(codeLoc, llvmVal);
 }
 
 bool Compiler::performBlockSetUp(CodeLoc codeLoc, SymbolTable::Block &block) {
+    setLlvmDebugLoc(codeLoc);
+
     if (!checkInLocalScope(codeLoc, true)) return false;
 
     llvm::BasicBlock *llvmBlockBody = llvm::BasicBlock::Create(llvmContext, "body", getLlvmCurrFunction());
@@ -239,6 +547,8 @@ optional<bool> Compiler::performBlockBody(CodeLoc codeLoc, SymbolTable::Block bl
 
 // TODO if a compiled block has a jump not at the end, llvm will report it instead of this compiler (eg. on two consecutive pass instructions)
 NodeVal Compiler::performBlockTearDown(CodeLoc codeLoc, SymbolTable::Block block, bool success) {
+    setLlvmDebugLoc(codeLoc);
+
     if (!success) return NodeVal();
 
     if (!isLlvmBlockTerminated()) {
@@ -263,10 +573,14 @@ NodeVal Compiler::performBlockTearDown(CodeLoc codeLoc, SymbolTable::Block block
 }
 
 bool Compiler::performExit(CodeLoc codeLoc, SymbolTable::Block block, const NodeVal &cond) {
+    setLlvmDebugLoc(codeLoc);
+
     return doCondBlockJump(codeLoc, cond, block.name, block.blockExit);
 }
 
 bool Compiler::performLoop(CodeLoc codeLoc, SymbolTable::Block block, const NodeVal &cond) {
+    setLlvmDebugLoc(codeLoc);
+
     return doCondBlockJump(codeLoc, cond, block.name, block.blockLoop);
 }
 
@@ -274,6 +588,7 @@ bool Compiler::performPass(CodeLoc codeLoc, SymbolTable::Block block, NodeVal va
     if (!checkInLocalScope(codeLoc, true)) return false;
 
     if (!callDropFuncsFromBlockToCurrBlock(codeLoc, block.name)) return false;
+    setLlvmDebugLoc(codeLoc);
 
     NodeVal valPromo = promoteIfEvalValAndCheckIsLlvmVal(val, true);
     if (valPromo.isInvalid()) return false;
@@ -285,7 +600,66 @@ bool Compiler::performPass(CodeLoc codeLoc, SymbolTable::Block block, NodeVal va
     return true;
 }
 
+bool Compiler::performMovedFrom(CodeLoc codeLoc, VarId varId) {
+    setLlvmDebugLoc(codeLoc);
+
+    const NodeVal &var = symbolTable->getVar(varId).var;
+    if (!var.isLlvmVal()) return true;
+
+    auto loc = llvmDropFlags.find(var.getLlvmVal().ref);
+    if (loc == llvmDropFlags.end() || loc->second.addrTaken) return true;
+
+    loc->second.llvmMovedStores.push_back(llvmBuilder.CreateStore(getLlvmConstB(false), loc->second.llvmFlag));
+
+    return true;
+}
+
+DropGuardSignal Compiler::performDropGuardSetUp(CodeLoc codeLoc, VarId varId) {
+    setLlvmDebugLoc(codeLoc);
+
+    DropGuardSignal signal;
+
+    const NodeVal &var = symbolTable->getVar(varId).var;
+    if (!var.isLlvmVal()) return signal;
+
+    auto loc = llvmDropFlags.find(var.getLlvmVal().ref);
+    if (loc == llvmDropFlags.end() || loc->second.addrTaken || loc->second.llvmMovedStores.empty()) return signal;
+
+    llvm::BasicBlock *llvmBlockDrop = llvm::BasicBlock::Create(llvmContext, "drop", getLlvmCurrFunction());
+    signal.llvmBlockAfter = llvm::BasicBlock::Create(llvmContext, "after_drop");
+    signal.guarded = true;
+
+    llvm::AllocaInst *llvmFlag = loc->second.llvmFlag;
+    llvm::Value *llvmFlagVal = llvmBuilder.CreateLoad(llvmFlag->getAllocatedType(), llvmFlag, "drop_flag");
+    llvmBuilder.CreateCondBr(llvmFlagVal, llvmBlockDrop, signal.llvmBlockAfter);
+    llvmBuilder.SetInsertPoint(llvmBlockDrop);
+
+    return signal;
+}
+
+bool Compiler::performDropGuardTearDown(CodeLoc codeLoc, DropGuardSignal signal) {
+    setLlvmDebugLoc(codeLoc);
+
+    if (!signal.guarded) return true;
+
+    llvmBuilder.CreateBr(signal.llvmBlockAfter);
+    getLlvmCurrFunction()->getBasicBlockList().push_back(signal.llvmBlockAfter);
+    llvmBuilder.SetInsertPoint(signal.llvmBlockAfter);
+
+    return true;
+}
+
 bool Compiler::performDataDefinition(CodeLoc codeLoc, TypeTable::Id ty) {
+    const TypeTable::DataType &data = typeTable->getDataType(ty);
+    if (data.defined && data.alignment > 0) {
+        if (targetMachine == nullptr && !initLlvmTargetMachine()) return false;
+
+        if (!isLlvmAlignmentPadSupported(data.alignment)) {
+            msgs->errorDataAlignmentUnsupported(codeLoc, data.alignment);
+            return false;
+        }
+    }
+
     // replace a previous compiled declaration with a definition
     if (typeTable->getLlvmType(ty) != nullptr) {
         return makeLlvmTypeOrError(codeLoc, ty) != nullptr;
@@ -296,55 +670,131 @@ bool Compiler::performDataDefinition(CodeLoc codeLoc, TypeTable::Id ty) {
 }
 
 NodeVal Compiler::performCall(CodeLoc codeLoc, CodeLoc codeLocFunc, const NodeVal &func, const std::vector<NodeVal> &args) {
+    return makeLlvmCall(codeLoc, codeLocFunc, func, args, true);
+}
+
+NodeVal Compiler::performCall(CodeLoc codeLoc, CodeLoc codeLocFunc, FuncId funcId, const std::vector<NodeVal> &args) {
+    const FuncValue &func = symbolTable->getFunc(funcId);
+
+    if (!checkIsLlvmFunc(codeLocFunc, func, true)) return NodeVal();
+
+    // calling directly, so no need to go through the by-ref ABI thunk that loading the function would give
+    LlvmVal llvmVal;
+    llvmVal.type = func.getType();
+    llvmVal.val = func.llvmFunc;
+    return makeLlvmCall(codeLoc, codeLocFunc, NodeVal(codeLocFunc, llvmVal), args, hasLlvmByRefAbi(func));
+}
+
+NodeVal Compiler::makeLlvmCall(CodeLoc codeLoc, CodeLoc codeLocFunc, const NodeVal &func, const std::vector<NodeVal> &args, bool byRefAbi) {
+    setLlvmDebugLoc(codeLoc);
+
     if (!checkInLocalScope(codeLocFunc, true)) return NodeVal();
 
     NodeVal funcPromo = promoteIfEvalValAndCheckIsLlvmVal(func, true);
     if (funcPromo.isInvalid()) return NodeVal();
 
-    vector<llvm::Value*> llvmArgValues(args.size());
+    const TypeTable::Callable *callable = typeTable->extractCallable(funcPromo.getLlvmVal().type);
+    if (callable == nullptr) {
+        msgs->errorInternal(codeLocFunc);
+        return NodeVal();
+    }
+
+    bool retByRef = byRefAbi && isLlvmRetByRef(*callable);
+
+    vector<llvm::Value*> llvmArgValues;
+    llvmArgValues.reserve(args.size()+1);
+
+    llvm::Type *llvmRetType = nullptr;
+    llvm::AllocaInst *llvmRetRef = nullptr;
+    if (retByRef) {
+        llvmRetType = makeLlvmTypeOrError(codeLoc, callable->retType.value());
+        if (llvmRetType == nullptr) return NodeVal();
+
+        llvmRetRef = makeLlvmAlloca(llvmRetType, "ret_tmp");
+        llvmArgValues.push_back(llvmRetRef);
+    }
+
     for (size_t i = 0; i < args.size(); ++i) {
+        llvm::Value *llvmArgValue;
         if (args[i].isEvalVal()) {
             NodeVal llvmArg = promoteEvalVal(args[i]);
             if (llvmArg.isInvalid()) return NodeVal();
-            llvmArgValues[i] = llvmArg.getLlvmVal().val;
+            llvmArgValue = llvmArg.getLlvmVal().val;
         } else if (args[i].isLlvmVal()) {
-            llvmArgValues[i] = args[i].getLlvmVal().val;
+            llvmArgValue = args[i].getLlvmVal().val;
         } else {
             msgs->errorInternal(args[i].getCodeLoc());
             return NodeVal();
         }
-    }
 
-    const TypeTable::Callable *callable = typeTable->extractCallable(funcPromo.getLlvmVal().type);
-    if (callable == nullptr) {
-        msgs->errorInternal(codeLocFunc);
-        return NodeVal();
+        // callee receives a pointer to its own copy, which it is free to modify
+        if (byRefAbi && i < callable->getArgCnt() && isLlvmPassedByRef(callable->getArgType(i))) {
+            llvm::Type *llvmArgType = makeLlvmTypeOrError(args[i].getCodeLoc(), callable->getArgType(i));
+            if (llvmArgType == nullptr) return NodeVal();
+
+            llvm::AllocaInst *llvmArgCopy = makeLlvmAlloca(llvmArgType, "arg_tmp");
+            llvmBuilder.CreateStore(llvmArgValue, llvmArgCopy);
+            llvmArgValue = llvmArgCopy;
+        }
+
+        llvmArgValues.push_back(llvmArgValue);
     }
 
-    llvm::FunctionCallee llvmFuncCallee = llvm::FunctionCallee(makeLlvmFunctionType(funcPromo.getLlvmVal().type), funcPromo.getLlvmVal().val);
+    llvm::FunctionCallee llvmFuncCallee = llvm::FunctionCallee(makeLlvmFunctionType(funcPromo.getLlvmVal().type, byRefAbi), funcPromo.getLlvmVal().val);
 
     if (callable->hasRet()) {
         LlvmVal retLlvmVal(callable->retType.value());
-        retLlvmVal.val = llvmBuilder.CreateCall(llvmFuncCallee, llvmArgValues, "call_tmp");
+        if (retByRef) {
+            llvm::CallInst *llvmCall = llvmBuilder.CreateCall(llvmFuncCallee, llvmArgValues, "");
+            if (byRefAbi) addLlvmByRefAttrs(llvmCall, *callable);
+            retLlvmVal.val = llvmBuilder.CreateLoad(llvmRetType, llvmRetRef, "call_tmp");
+        } else {
+            llvm::CallInst *llvmCall = llvmBuilder.CreateCall(llvmFuncCallee, llvmArgValues, "call_tmp");
+            if (byRefAbi) addLlvmByRefAttrs(llvmCall, *callable);
+            retLlvmVal.val = llvmCall;
+        }
         return NodeVal(codeLoc, retLlvmVal);
     } else {
-        llvmBuilder.CreateCall(llvmFuncCallee, llvmArgValues, "");
+        llvm::CallInst *llvmCall = llvmBuilder.CreateCall(llvmFuncCallee, llvmArgValues, "");
+        if (byRefAbi) addLlvmByRefAttrs(llvmCall, *callable);
         return NodeVal(codeLoc);
     }
 }
 
-NodeVal Compiler::performCall(CodeLoc codeLoc, CodeLoc codeLocFunc, FuncId funcId, const std::vector<NodeVal> &args) {
-    NodeVal nodeFunc = performLoad(codeLocFunc, funcId);
-    if (nodeFunc.isInvalid()) return NodeVal();
-
-    return performCall(codeLoc, codeLocFunc, nodeFunc, args);
-}
-
 NodeVal Compiler::performInvoke(CodeLoc codeLoc, MacroId macroId, std::vector<NodeVal> args) {
     msgs->errorInternal(codeLoc);
     return NodeVal();
 }
 
+bool Compiler::performExpansionSetUp(CodeLoc codeLoc, MacroId macroId) {
+    if (llvmDiBuilder == nullptr) return true;
+
+    const MacroValue &macro = symbolTable->getMacro(macroId);
+
+    llvm::DISubprogram *&llvmDiMacro = llvmDiMacros[macro.body.get()];
+    if (llvmDiMacro == nullptr) {
+        llvmDiMacro = makeLlvmDiSubprogram(macro.codeLoc, macro.name, "");
+        llvmDiBuilder->finalizeSubprogram(llvmDiMacro);
+    }
+
+    DebugExpansion expansion;
+    expansion.codeLocBody = macro.body->getCodeLoc();
+    expansion.llvmDiMacro = llvmDiMacro;
+    expansion.llvmDiInlinedAt = makeLlvmDebugLoc(codeLoc);
+    debugExpansions.push_back(expansion);
+
+    return true;
+}
+
+bool Compiler::performExpansionTearDown(CodeLoc codeLoc) {
+    if (llvmDiBuilder == nullptr) return true;
+
+    debugExpansions.pop_back();
+    setLlvmDebugLoc(codeLoc);
+
+    return true;
+}
+
 bool Compiler::performFunctionDeclaration(CodeLoc codeLoc, FuncValue &func) {
     optional<string> funcLlvmName = getFuncNameForLlvm(func);
     if (!funcLlvmName.has_value()) {
@@ -354,7 +804,7 @@ bool Compiler::performFunctionDeclaration(CodeLoc codeLoc, FuncValue &func) {
 
     func.llvmFunc = llvmModule->getFunction(funcLlvmName.value());
     if (func.llvmFunc == nullptr) {
-        llvm::FunctionType *llvmFuncType = makeLlvmFunctionType(func.getType());
+        llvm::FunctionType *llvmFuncType = makeLlvmFunctionType(func.getType(), hasLlvmByRefAbi(func));
         if (llvmFuncType == nullptr) {
             msgs->errorTypeCannotCompile(codeLoc, func.getType());
             return false;
@@ -363,16 +813,52 @@ bool Compiler::performFunctionDeclaration(CodeLoc codeLoc, FuncValue &func) {
         func.llvmFunc = llvm::Function::Create(llvmFuncType, llvm::Function::LinkageTypes::ExternalLinkage, funcLlvmName.value(), llvmModule.get());
     }
 
+    TypeTable::Callable callable = FuncValue::getCallable(func, typeTable);
+    bool byRefAbi = hasLlvmByRefAbi(func);
+    if (byRefAbi) addLlvmByRefAttrs(func.llvmFunc, callable);
+    size_t llvmArgOffset = byRefAbi && isLlvmRetByRef(callable) ? 1 : 0;
+    for (size_t i = 0; i < callable.getArgCnt(); ++i) {
+        if (callable.getArgNoAlias(i)) func.llvmFunc->addParamAttr(i+llvmArgOffset, llvm::Attribute::NoAlias);
+    }
+
+    if (func.optAttrs.alwaysInline) func.llvmFunc->addFnAttr(llvm::Attribute::AlwaysInline);
+    if (func.optAttrs.noInline) func.llvmFunc->addFnAttr(llvm::Attribute::NoInline);
+    if (func.optAttrs.hot) func.llvmFunc->addFnAttr(llvm::Attribute::Hot);
+    if (func.optAttrs.cold) func.llvmFunc->addFnAttr(llvm::Attribute::Cold);
+    if (func.optAttrs.readNone) func.llvmFunc->addFnAttr(llvm::Attribute::ReadNone);
+    if (func.optAttrs.readOnly) func.llvmFunc->addFnAttr(llvm::Attribute::ReadOnly);
+    if (func.optAttrs.noReturn) func.llvmFunc->addFnAttr(llvm::Attribute::NoReturn);
+    if (func.optAttrs.minSize) {
+        func.llvmFunc->addFnAttr(llvm::Attribute::MinSize);
+        func.llvmFunc->addFnAttr(llvm::Attribute::OptimizeForSize);
+    }
+
     return true;
 }
 
 bool Compiler::performFunctionDefinition(CodeLoc codeLoc, const NodeVal &args, const NodeVal &body, FuncValue &func) {
-    if (link && !isMeaningful(func.name, Meaningful::MAIN)) {
+    if (link && !isMeaningful(func.name, Meaningful::MAIN, namePool)) {
         func.llvmFunc->setLinkage(llvm::Function::LinkageTypes::PrivateLinkage);
+    } else if (isFromInterface(codeLoc)) {
+        // the object of the interface has the same definition
+        func.llvmFunc->setLinkage(llvm::Function::LinkageTypes::LinkOnceODRLinkage);
+    } else if (emitInterface && !isMeaningful(func.name, Meaningful::MAIN, namePool)) {
+        // objects importing the interface may also import the same files
+        func.llvmFunc->setLinkage(llvm::Function::LinkageTypes::WeakODRLinkage);
     }
 
     BlockRaii blockRaii(symbolTable, SymbolTable::CalleeValueInfo::make(func, typeTable));
 
+    unordered_map<llvm::Value*, DropFlag> prevLlvmDropFlags = move(llvmDropFlags);
+    llvmDropFlags.clear();
+
+    llvm::DebugLoc prevLlvmDebugLoc = llvmBuilder.getCurrentDebugLocation();
+    vector<DebugExpansion> prevDebugExpansions = move(debugExpansions);
+    debugExpansions.clear();
+    if (llvmDiBuilder != nullptr) {
+        func.llvmFunc->setSubprogram(makeLlvmDiSubprogram(codeLoc, func.name, func.llvmFunc->getName().str()));
+    }
+
     TypeTable::Callable callable = FuncValue::getCallable(func, typeTable);
 
     llvm::BasicBlock *prevLlvmBuilderAllocaInsertPoint = llvmBuilderAlloca.GetInsertBlock();
@@ -381,19 +867,35 @@ bool Compiler::performFunctionDefinition(CodeLoc codeLoc, const NodeVal &args, c
     llvm::BasicBlock *prevLlvmBuilderInsertPoint = llvmBuilder.GetInsertBlock();
     llvm::BasicBlock *llvmBlockBody = llvm::BasicBlock::Create(llvmContext, "entry", func.llvmFunc);
     llvmBuilder.SetInsertPoint(llvmBlockBody);
+    setLlvmDebugLoc(codeLoc);
+
+    bool byRefAbi = hasLlvmByRefAbi(func);
+    size_t llvmArgOffset = byRefAbi && isLlvmRetByRef(callable) ? 1 : 0;
+    for (size_t i = 0; i < callable.getArgCnt(); ++i) {
+        llvm::Argument *llvmFuncArg = func.llvmFunc->getArg(i+llvmArgOffset);
 
-    size_t i = 0;
-    for (auto &llvmFuncArg : func.llvmFunc->args()) {
         llvm::Type *llvmArgType = makeLlvmTypeOrError(args.getChild(i).getCodeLoc(), callable.getArgType(i));
         if (llvmArgType == nullptr) return false;
 
-        llvm::AllocaInst *llvmAlloca = makeLlvmAlloca(llvmArgType, getNameForLlvm(func.argNames[i]));
-        llvmBuilder.CreateStore(&llvmFuncArg, llvmAlloca);
+        llvm::Value *llvmRef;
+        if (byRefAbi && isLlvmPassedByRef(callable.getArgType(i))) {
+            // the caller made a copy for this call, so it can be used as the variable directly
+            llvmFuncArg->setName(getNameForLlvm(func.argNames[i]));
+            llvmRef = llvmFuncArg;
+        } else {
+            llvmRef = makeLlvmAlloca(llvmArgType, getNameForLlvm(func.argNames[i]));
+            llvmBuilder.CreateStore(llvmFuncArg, llvmRef);
+        }
+
+        if (!callable.getArgNoDrop(i) && !hasTrivialDrop(callable.getArgType(i))) makeLlvmDropFlag(llvmRef);
+        declareLlvmDebugVar(args.getChild(i).getCodeLoc(), func.argNames[i], callable.getArgType(i), llvmRef, i+1);
 
         LlvmVal varLlvmVal(callable.getArgType(i));
-        varLlvmVal.ref = llvmAlloca;
-        varLlvmVal.lifetimeInfo.noDrop = callable.getArgNoDrop(i);
-        varLlvmVal.lifetimeInfo.nestLevel = symbolTable->currNestLevel();
+        varLlvmVal.ref = llvmRef;
+        LifetimeInfo lifetimeInfo;
+        lifetimeInfo.noDrop = callable.getArgNoDrop(i);
+        lifetimeInfo.nestLevel = symbolTable->currNestLevel();
+        varLlvmVal.setLifetimeInfo(lifetimeInfo);
 
         NodeVal varNodeVal(args.getChild(i).getCodeLoc(), varLlvmVal);
 
@@ -401,8 +903,6 @@ bool Compiler::performFunctionDefinition(CodeLoc codeLoc, const NodeVal &args, c
         varEntry.name = func.argNames[i];
         varEntry.var = move(varNodeVal);
         symbolTable->addVar(move(varEntry));
-
-        ++i;
     }
 
     if (!processChildNodes(body)) {
@@ -416,6 +916,7 @@ bool Compiler::performFunctionDefinition(CodeLoc codeLoc, const NodeVal &args, c
         if (!callable.hasRet()) {
             // if llvm block is terminated, these have been called already
             if (!callDropFuncsCurrCallable(codeLoc)) return false;
+            setLlvmDebugLoc(codeLoc);
 
             llvmBuilder.CreateRetVoid();
         } else {
@@ -424,11 +925,15 @@ bool Compiler::performFunctionDefinition(CodeLoc codeLoc, const NodeVal &args, c
         }
     }
 
-    if (llvm::verifyFunction(*func.llvmFunc, &llvm::errs())) cerr << endl;
-    llvmFpm->run(*func.llvmFunc);
+    if (llvmDiBuilder != nullptr) llvmDiBuilder->finalizeSubprogram(func.llvmFunc->getSubprogram());
+
+    // verification and function passes are deferred until it is known whether the function is referenced
 
     if (prevLlvmBuilderInsertPoint != nullptr) llvmBuilder.SetInsertPoint(prevLlvmBuilderInsertPoint);
     if (prevLlvmBuilderAllocaInsertPoint != nullptr) llvmBuilderAlloca.SetInsertPoint(prevLlvmBuilderAllocaInsertPoint);
+    llvmDropFlags = move(prevLlvmDropFlags);
+    llvmBuilder.SetCurrentDebugLocation(prevLlvmDebugLoc);
+    debugExpansions = move(prevDebugExpansions);
 
     return true;
 }
@@ -440,6 +945,7 @@ bool Compiler::performMacroDefinition(CodeLoc codeLoc, const NodeVal &args, cons
 
 bool Compiler::performRet(CodeLoc codeLoc) {
     if (!callDropFuncsCurrCallable(codeLoc)) return false;
+    setLlvmDebugLoc(codeLoc);
 
     // Processor already checked we are in local scope
     llvmBuilder.CreateRetVoid();
@@ -453,13 +959,22 @@ bool Compiler::performRet(CodeLoc codeLoc, NodeVal node) {
     NodeVal promo = promoteIfEvalValAndCheckIsLlvmVal(node, true);
     if (promo.isInvalid()) return false;
 
+    setLlvmDebugLoc(codeLoc);
+
     // Processor already checked we are in local scope
-    llvmBuilder.CreateRet(promo.getLlvmVal().val);
+    if (getLlvmCurrFunction()->hasStructRetAttr()) {
+        llvmBuilder.CreateStore(promo.getLlvmVal().val, getLlvmCurrFunction()->getArg(0));
+        llvmBuilder.CreateRetVoid();
+    } else {
+        llvmBuilder.CreateRet(promo.getLlvmVal().val);
+    }
 
     return true;
 }
 
 NodeVal Compiler::performOperUnary(CodeLoc codeLoc, NodeVal oper, Oper op) {
+    setLlvmDebugLoc(codeLoc);
+
     if (!checkInLocalScope(codeLoc, true)) return NodeVal();
 
     NodeVal promo = promoteIfEvalValAndCheckIsLlvmVal(oper, true);
@@ -495,6 +1010,7 @@ NodeVal Compiler::performOperUnary(CodeLoc codeLoc, NodeVal oper, Oper op) {
         if (llvmInRef != nullptr) {
             llvmVal.type = typeTable->addTypeAddrOf(operTy);
             llvmVal.val = llvmInRef;
+            markLlvmAddrTaken(llvmInRef);
         } else {
             msgs->errorExprAddrOfNonRef(codeLoc);
             errorGiven = true;
@@ -510,18 +1026,22 @@ NodeVal Compiler::performOperUnary(CodeLoc codeLoc, NodeVal oper, Oper op) {
 }
 
 NodeVal Compiler::performOperUnaryDeref(CodeLoc codeLoc, const NodeVal &oper, TypeTable::Id resTy) {
+    setLlvmDebugLoc(codeLoc);
+
     if (!checkInLocalScope(codeLoc, true)) return NodeVal();
     if (!checkIsLlvmVal(oper, true)) return NodeVal();
 
     llvm::Value *llvmIn = oper.getLlvmVal().val;
 
     LlvmVal llvmVal(resTy);
-    llvmVal.val = llvmBuilder.CreateLoad(llvmIn, "deref_tmp");
     llvmVal.ref = llvmIn;
+    llvmVal.val = makeLlvmLoad(llvmVal.ref, getLlvmRefAlign(llvmVal), "deref_tmp");
     return NodeVal(codeLoc, llvmVal);
 }
 
 ComparisonSignal Compiler::performOperComparisonSetUp(CodeLoc codeLoc, size_t opersCnt) {
+    setLlvmDebugLoc(codeLoc);
+
     ComparisonSignal compSignal;
 
     llvm::BasicBlock *llvmBlockCurr = llvmBuilder.GetInsertBlock();
@@ -535,7 +1055,9 @@ ComparisonSignal Compiler::performOperComparisonSetUp(CodeLoc codeLoc, size_t op
     return compSignal;
 }
 
-optional<bool> Compiler::performOperComparison(CodeLoc codeLoc, const NodeVal &lhs, const NodeVal &rhs, Oper op, ComparisonSignal &signal) {
+optional<bool> Compiler::performOperComparison(CodeLoc codeLoc, const NodeVal &lhs, const NodeVal &rhs, Oper op, FastMathAttrs fastMath, ComparisonSignal &signal) {
+    setLlvmDebugLoc(codeLoc);
+
     if (!checkInLocalScope(codeLoc, true)) return nullopt;
 
     NodeVal lhsPromo = promoteIfEvalValAndCheckIsLlvmVal(lhs, true);
@@ -552,6 +1074,9 @@ optional<bool> Compiler::performOperComparison(CodeLoc codeLoc, const NodeVal &l
     bool isTypeB = typeTable->worksAsTypeB(lhsPromo.getType().value());
     bool isTypeCall = typeTable->worksAsCallable(lhsPromo.getType().value());
 
+    llvm::IRBuilderBase::FastMathFlagGuard llvmFmfGuard(llvmBuilder);
+    llvmBuilder.setFastMathFlags(makeLlvmFastMathFlags(fastMath));
+
     llvm::Value *llvmValueRes = nullptr;
 
     switch (op) {
@@ -635,6 +1160,8 @@ optional<bool> Compiler::performOperComparison(CodeLoc codeLoc, const NodeVal &l
 }
 
 NodeVal Compiler::performOperComparisonTearDown(CodeLoc codeLoc, bool success, ComparisonSignal signal) {
+    setLlvmDebugLoc(codeLoc);
+
     if (!checkInLocalScope(codeLoc, true)) return NodeVal();
 
     if (!success) {
@@ -654,6 +1181,8 @@ NodeVal Compiler::performOperComparisonTearDown(CodeLoc codeLoc, bool success, C
 }
 
 NodeVal Compiler::performOperAssignment(CodeLoc codeLoc, const NodeVal &lhs, NodeVal rhs) {
+    setLlvmDebugLoc(codeLoc);
+
     if (!checkInLocalScope(codeLoc, true)) return NodeVal();
 
     if (!checkIsLlvmVal(lhs, true)) return NodeVal();
@@ -661,18 +1190,27 @@ NodeVal Compiler::performOperAssignment(CodeLoc codeLoc, const NodeVal &lhs, Nod
     NodeVal rhsPromo = promoteIfEvalValAndCheckIsLlvmVal(rhs, true);
     if (rhsPromo.isInvalid()) return NodeVal();
 
-    llvmBuilder.CreateStore(rhsPromo.getLlvmVal().val, lhs.getLlvmVal().ref);
+    makeLlvmStore(rhsPromo.getLlvmVal().val, lhs.getLlvmVal().ref, getLlvmRefAlign(lhs.getLlvmVal()));
 
     LlvmVal llvmVal(lhs.getType().value());
     llvmVal.val = rhsPromo.getLlvmVal().val;
     llvmVal.ref = lhs.getLlvmVal().ref;
-    llvmVal.lifetimeInfo = lhs.getLlvmVal().lifetimeInfo;
+    llvmVal.refAlign = lhs.getLlvmVal().refAlign;
+    llvmVal.setLifetimeInfo(lhs.getLlvmVal().getLifetimeInfo());
     return NodeVal(lhs.getCodeLoc(), llvmVal);
 }
 
 NodeVal Compiler::performOperIndexArr(CodeLoc codeLoc, NodeVal &base, const NodeVal &ind, TypeTable::Id resTy) {
+    setLlvmDebugLoc(codeLoc);
+
     if (!checkInLocalScope(codeLoc, true)) return NodeVal();
 
+    // member offsets come from the data layout
+    if (targetMachine == nullptr && !initLlvmTargetMachine()) {
+        msgs->errorInternal(codeLoc);
+        return NodeVal();
+    }
+
     NodeVal basePromo = promoteIfEvalValAndCheckIsLlvmVal(base, true);
     if (basePromo.isInvalid()) return NodeVal();
 
@@ -682,7 +1220,7 @@ NodeVal Compiler::performOperIndexArr(CodeLoc codeLoc, NodeVal &base, const Node
     LlvmVal llvmVal(resTy);
     if (typeTable->worksAsTypeArrP(basePromo.getType().value())) {
         llvmVal.ref = llvmBuilder.CreateGEP(basePromo.getLlvmVal().val, indPromo.getLlvmVal().val);
-        llvmVal.val = llvmBuilder.CreateLoad(llvmVal.ref, "index_tmp");
+        llvmVal.val = makeLlvmLoad(llvmVal.ref, getLlvmRefAlign(llvmVal), "index_tmp");
     } else if (typeTable->worksAsTypeArr(basePromo.getType().value())) {
         llvm::Type *llvmTypeInd = makeLlvmTypeOrError(indPromo.getCodeLoc(), indPromo.getType().value());
         if (llvmTypeInd == nullptr) return NodeVal();
@@ -690,20 +1228,24 @@ NodeVal Compiler::performOperIndexArr(CodeLoc codeLoc, NodeVal &base, const Node
         if (basePromo.hasRef()) {
             llvmVal.ref = llvmBuilder.CreateGEP(basePromo.getLlvmVal().ref,
                 {llvm::ConstantInt::get(llvmTypeInd, 0), indPromo.getLlvmVal().val});
-            llvmVal.val = llvmBuilder.CreateLoad(llvmVal.ref, "index_tmp");
+            // any element, so only what all their offsets have in common
+            llvm::Type *llvmTypeElem = llvmVal.ref->getType()->getPointerElementType();
+            llvmVal.refAlign = getLlvmMemberRefAlign(basePromo.getLlvmVal(), llvmTypeElem,
+                llvmModule->getDataLayout().getTypeAllocSize(llvmTypeElem).getFixedSize());
+            llvmVal.val = makeLlvmLoad(llvmVal.ref, getLlvmRefAlign(llvmVal), "index_tmp");
         } else {
             llvm::Type *llvmTypeBase = makeLlvmTypeOrError(basePromo.getCodeLoc(), basePromo.getType().value());
             if (llvmTypeBase == nullptr) return NodeVal();
 
             // llvm's extractvalue would require compile-time constant indices
             llvm::Value *tmp = makeLlvmAlloca(llvmTypeBase, "tmp");
-            llvmBuilder.CreateStore(basePromo.getLlvmVal().val, tmp);
+            makeLlvmStore(basePromo.getLlvmVal().val, tmp, getLlvmAlign(llvmTypeBase));
             tmp = llvmBuilder.CreateGEP(tmp,
                 {llvm::ConstantInt::get(llvmTypeInd, 0), indPromo.getLlvmVal().val});
-            llvmVal.val = llvmBuilder.CreateLoad(tmp, "index_tmp");
+            llvmVal.val = makeLlvmLoad(tmp, getLlvmAlign(tmp->getType()->getPointerElementType()), "index_tmp");
         }
 
-        llvmVal.lifetimeInfo = basePromo.getLlvmVal().lifetimeInfo;
+        llvmVal.setLifetimeInfo(basePromo.getLlvmVal().getLifetimeInfo());
     } else {
         msgs->errorInternal(codeLoc);
         return NodeVal();
@@ -713,23 +1255,36 @@ NodeVal Compiler::performOperIndexArr(CodeLoc codeLoc, NodeVal &base, const Node
 }
 
 NodeVal Compiler::performOperIndex(CodeLoc codeLoc, NodeVal &base, std::uint64_t ind, TypeTable::Id resTy) {
+    setLlvmDebugLoc(codeLoc);
+
     if (!checkInLocalScope(codeLoc, true)) return NodeVal();
 
+    // member offsets come from the data layout
+    if (targetMachine == nullptr && !initLlvmTargetMachine()) {
+        msgs->errorInternal(codeLoc);
+        return NodeVal();
+    }
+
     NodeVal basePromo = promoteIfEvalValAndCheckIsLlvmVal(base, true);
     if (basePromo.isInvalid()) return NodeVal();
 
     LlvmVal llvmVal(resTy);
     if (basePromo.hasRef()) {
         llvmVal.ref = llvmBuilder.CreateStructGEP(basePromo.getLlvmVal().ref, (unsigned) ind);
-        llvmVal.val = llvmBuilder.CreateLoad(llvmVal.ref, "ind_tmp");
+        llvm::StructType *llvmTypeBase = (llvm::StructType*) basePromo.getLlvmVal().ref->getType()->getPointerElementType();
+        llvmVal.refAlign = getLlvmMemberRefAlign(basePromo.getLlvmVal(), llvmTypeBase->getElementType((unsigned) ind),
+            llvmModule->getDataLayout().getStructLayout(llvmTypeBase)->getElementOffset((unsigned) ind));
+        llvmVal.val = makeLlvmLoad(llvmVal.ref, getLlvmRefAlign(llvmVal), "ind_tmp");
     } else {
         llvmVal.val = llvmBuilder.CreateExtractValue(basePromo.getLlvmVal().val, {(unsigned) ind}, "ind_tmp");
     }
-    llvmVal.lifetimeInfo = basePromo.getLlvmVal().lifetimeInfo;
+    llvmVal.setLifetimeInfo(basePromo.getLlvmVal().getLifetimeInfo());
     return NodeVal(codeLoc, llvmVal);
 }
 
 NodeVal Compiler::performOperRegular(CodeLoc codeLoc, const NodeVal &lhs, const NodeVal &rhs, Oper op, OperRegAttrs attrs) {
+    setLlvmDebugLoc(codeLoc);
+
     if (!checkInLocalScope(codeLoc, true)) return NodeVal();
 
     NodeVal lhsPromo = promoteIfEvalValAndCheckIsLlvmVal(lhs, true);
@@ -744,6 +1299,9 @@ NodeVal Compiler::performOperRegular(CodeLoc codeLoc, const NodeVal &lhs, const
     bool isTypeU = typeTable->worksAsTypeU(llvmVal.type);
     bool isTypeF = typeTable->worksAsTypeF(llvmVal.type);
 
+    llvm::IRBuilderBase::FastMathFlagGuard llvmFmfGuard(llvmBuilder);
+    llvmBuilder.setFastMathFlags(makeLlvmFastMathFlags(attrs.fastMath));
+
     switch (op) {
     case Oper::ADD:
         if (isTypeI || isTypeU) {
@@ -850,6 +1408,7 @@ bool Compiler::doCondBlockJump(CodeLoc codeLoc, const NodeVal &cond, optional<Na
     llvmBuilder.SetInsertPoint(llvmBlockDrops);
 
     if (!callDropFuncsFromBlockToCurrBlock(codeLoc, blockName)) return false;
+    setLlvmDebugLoc(codeLoc);
 
     llvmBuilder.CreateBr(llvmBlock);
 
@@ -915,6 +1474,8 @@ NodeVal Compiler::promoteEvalVal(CodeLoc codeLoc, const EvalVal &eval) {
             if (elemPromo.isInvalid()) return NodeVal();
             llvmConsts.push_back((llvm::Constant*) elemPromo.getLlvmVal().val);
         }
+        const TypeTable::DataType &dataType = *typeTable->extractDataType(eval.getType());
+        if (dataType.alignment > 0) llvmConsts.push_back(llvm::Constant::getNullValue(makeLlvmAlignmentPad(dataType.alignment)));
 
         llvmConst = llvm::ConstantStruct::get(llvmStructType, llvmConsts);
     } else if (EvalVal::isFunc(eval, typeTable)) {
@@ -934,7 +1495,9 @@ NodeVal Compiler::promoteEvalVal(CodeLoc codeLoc, const EvalVal &eval) {
 
     LlvmVal llvmVal(ty);
     llvmVal.val = llvmConst;
-    llvmVal.lifetimeInfo.noDrop = eval.getLifetimeInfo().noDrop;
+    LifetimeInfo lifetimeInfo;
+    lifetimeInfo.noDrop = eval.getLifetimeInfo().noDrop;
+    llvmVal.setLifetimeInfo(lifetimeInfo);
 
     return NodeVal(codeLoc, llvmVal);
 }
@@ -953,6 +1516,20 @@ NodeVal Compiler::promoteIfEvalValAndCheckIsLlvmVal(const NodeVal &node, bool or
     return promo;
 }
 
+llvm::FastMathFlags Compiler::makeLlvmFastMathFlags(FastMathAttrs fastMath) const {
+    llvm::FastMathFlags llvmFmf;
+    if (fastMathAll || fastMath.fast) {
+        llvmFmf.setFast();
+    } else {
+        if (fastMath.reassoc) llvmFmf.setAllowReassoc();
+        if (fastMath.contract) llvmFmf.setAllowContract();
+        if (fastMath.nnan) llvmFmf.setNoNaNs();
+        if (fastMath.ninf) llvmFmf.setNoInfs();
+        if (fastMath.arcp) llvmFmf.setAllowReciprocal();
+    }
+    return llvmFmf;
+}
+
 string Compiler::getNameForLlvm(NamePool::Id name) const {
     // LLVM is smart enough to put quotes around IDs with special chars, but let's keep this method in anyway.
     return namePool->get(name);
@@ -981,22 +1558,116 @@ llvm::Constant* Compiler::makeLlvmConstString(const std::string &str) {
     return llvmBuilder.CreateGlobalStringPtr(str, "str_lit", 0, llvmModule.get());
 }
 
-llvm::FunctionType* Compiler::makeLlvmFunctionType(TypeTable::Id typeId) {
+llvm::FunctionType* Compiler::makeLlvmFunctionType(TypeTable::Id typeId, bool byRefAbi) {
     const TypeTable::Callable *callable = typeTable->extractCallable(typeId);
     if (callable == nullptr || !callable->isFunc) return nullptr;
 
-    vector<llvm::Type*> llvmArgTypes(callable->getArgCnt());
-    for (size_t i = 0; i < callable->getArgCnt(); ++i) {
-        llvmArgTypes[i] = makeLlvmType(callable->getArgType(i));
-        if (llvmArgTypes[i] == nullptr) return nullptr;
-    }
+    bool retByRef = byRefAbi && isLlvmRetByRef(*callable);
+
+    vector<llvm::Type*> llvmArgTypes;
+    llvmArgTypes.reserve(callable->getArgCnt()+1);
 
     llvm::Type *llvmRetType = callable->retType.has_value() ? makeLlvmType(callable->retType.value()) : llvm::Type::getVoidTy(llvmContext);
     if (llvmRetType == nullptr) return nullptr;
+    if (retByRef) {
+        llvmArgTypes.push_back(llvm::PointerType::get(llvmRetType, 0));
+        llvmRetType = llvm::Type::getVoidTy(llvmContext);
+    }
+
+    for (size_t i = 0; i < callable->getArgCnt(); ++i) {
+        llvm::Type *llvmArgType = makeLlvmType(callable->getArgType(i));
+        if (llvmArgType == nullptr) return nullptr;
+        if (byRefAbi && isLlvmPassedByRef(callable->getArgType(i))) llvmArgType = llvm::PointerType::get(llvmArgType, 0);
+        llvmArgTypes.push_back(llvmArgType);
+    }
 
     return llvm::FunctionType::get(llvmRetType, llvmArgTypes, callable->variadic);
 }
 
+bool Compiler::isLlvmPassedByRef(TypeTable::Id typeId) {
+    if (!typeTable->worksAsTypeArr(typeId) && !typeTable->worksAsTuple(typeId) && !typeTable->worksAsDataType(typeId)) return false;
+
+    llvm::Type *llvmType = makeLlvmType(typeId);
+    if (llvmType == nullptr || !llvmType->isSized()) return false;
+
+    if (targetMachine == nullptr && !initLlvmTargetMachine()) return false;
+
+    return llvmModule->getDataLayout().getTypeAllocSize(llvmType).getFixedSize() > byRefAggregateThreshold;
+}
+
+bool Compiler::isLlvmRetByRef(const TypeTable::Callable &callable) {
+    return callable.hasRet() && isLlvmPassedByRef(callable.retType.value());
+}
+
+bool Compiler::hasLlvmByRefArgOrRet(const TypeTable::Callable &callable) {
+    if (isLlvmRetByRef(callable)) return true;
+    for (size_t i = 0; i < callable.getArgCnt(); ++i) {
+        if (isLlvmPassedByRef(callable.getArgType(i))) return true;
+    }
+    return false;
+}
+
+llvm::Function* Compiler::getLlvmByRefAbiFunc(const FuncValue &func) {
+    TypeTable::Callable callable = FuncValue::getCallable(func, typeTable);
+    if (hasLlvmByRefAbi(func) || !hasLlvmByRefArgOrRet(callable)) return func.llvmFunc;
+    if (callable.variadic) return nullptr;
+
+    string llvmThunkName = func.llvmFunc->getName().str() + ".byref";
+    llvm::Function *llvmThunk = llvmModule->getFunction(llvmThunkName);
+    if (llvmThunk != nullptr) return llvmThunk;
+
+    llvm::FunctionType *llvmThunkType = makeLlvmFunctionType(func.getType(), true);
+    if (llvmThunkType == nullptr) return nullptr;
+
+    llvmThunk = llvm::Function::Create(llvmThunkType, llvm::Function::LinkageTypes::PrivateLinkage, llvmThunkName, llvmModule.get());
+    addLlvmByRefAttrs(llvmThunk, callable);
+
+    // not using llvmBuilder, as this may happen in the middle of compiling another function
+    llvm::IRBuilder<> llvmThunkBuilder(llvm::BasicBlock::Create(llvmContext, "entry", llvmThunk));
+
+    size_t llvmArgOffset = isLlvmRetByRef(callable) ? 1 : 0;
+    vector<llvm::Value*> llvmArgValues;
+    llvmArgValues.reserve(callable.getArgCnt());
+    for (size_t i = 0; i < callable.getArgCnt(); ++i) {
+        llvm::Value *llvmArgValue = llvmThunk->getArg(i+llvmArgOffset);
+        if (isLlvmPassedByRef(callable.getArgType(i))) {
+            llvm::Type *llvmArgType = makeLlvmType(callable.getArgType(i));
+            llvmArgValue = llvmThunkBuilder.CreateAlignedLoad(llvmArgType, llvmArgValue, getLlvmAlign(llvmArgType));
+        }
+        llvmArgValues.push_back(llvmArgValue);
+    }
+
+    llvm::CallInst *llvmCall = llvmThunkBuilder.CreateCall(func.llvmFunc, llvmArgValues);
+    if (llvmArgOffset > 0) {
+        llvmThunkBuilder.CreateAlignedStore(llvmCall, llvmThunk->getArg(0), getLlvmAlign(llvmCall->getType()));
+        llvmThunkBuilder.CreateRetVoid();
+    } else if (callable.hasRet()) {
+        llvmThunkBuilder.CreateRet(llvmCall);
+    } else {
+        llvmThunkBuilder.CreateRetVoid();
+    }
+
+    return llvmThunk;
+}
+
+template <typename T>
+void Compiler::addLlvmByRefAttrs(T *llvmFuncOrCall, const TypeTable::Callable &callable) {
+    size_t llvmArgOffset = 0;
+    if (isLlvmRetByRef(callable)) {
+        llvm::Type *llvmRetType = makeLlvmType(callable.retType.value());
+        llvmFuncOrCall->addParamAttr(0, llvm::Attribute::getWithStructRetType(llvmContext, llvmRetType));
+        llvmFuncOrCall->addParamAttr(0, llvm::Attribute::NoAlias);
+        llvmArgOffset = 1;
+    }
+
+    for (size_t i = 0; i < callable.getArgCnt(); ++i) {
+        if (isLlvmPassedByRef(callable.getArgType(i))) {
+            llvmFuncOrCall->addParamAttr(i+llvmArgOffset, llvm::Attribute::NoAlias);
+            llvmFuncOrCall->addParamAttr(i+llvmArgOffset, llvm::Attribute::NoCapture);
+        }
+    }
+}
+
 llvm::Type* Compiler::makeLlvmType(TypeTable::Id typeId) {
     llvm::Type *llvmType = typeTable->getLlvmType(typeId);
     if (llvmType != nullptr) {
@@ -1062,10 +1733,16 @@ llvm::Type* Compiler::makeLlvmType(TypeTable::Id typeId) {
                 if (elementType == nullptr) return nullptr;
                 elementTypes[i] = elementType;
             }
-            ((llvm::StructType*) llvmType)->setBody(elementTypes);
+            // zero-sized trailing member raises the struct's ABI alignment,
+            // so allocas, globals, sizeOf and nesting in other types all respect it
+            if (data.alignment > 0) {
+                if (!isLlvmAlignmentPadSupported(data.alignment)) return nullptr;
+                elementTypes.push_back(makeLlvmAlignmentPad(data.alignment));
+            }
+            ((llvm::StructType*) llvmType)->setBody(elementTypes, data.packed);
         }
     } else if (typeTable->isCallable(typeId)) {
-        llvmType = makeLlvmFunctionType(typeId);
+        llvmType = makeLlvmFunctionType(typeId, true);
         if (llvmType == nullptr) return nullptr;
         // make a function pointer type
         llvmType = llvm::PointerType::get(llvmType, 0);
@@ -1077,6 +1754,16 @@ llvm::Type* Compiler::makeLlvmType(TypeTable::Id typeId) {
     return llvmType;
 }
 
+llvm::Type* Compiler::makeLlvmAlignmentPad(std::uint64_t alignment) {
+    llvm::Type *llvmVecType = llvm::FixedVectorType::get(llvm::Type::getInt8Ty(llvmContext), alignment);
+    return llvm::ArrayType::get(llvmVecType, 0);
+}
+
+bool Compiler::isLlvmAlignmentPadSupported(std::uint64_t alignment) {
+    // some data layouts align vectors to less than their size
+    return getLlvmAlign(makeLlvmAlignmentPad(alignment)).value() >= alignment;
+}
+
 llvm::Type* Compiler::makeLlvmTypeOrError(CodeLoc codeLoc, TypeTable::Id typeId) {
     llvm::Type *ret = makeLlvmType(typeId);
     if (ret == nullptr) {
@@ -1118,6 +1805,7 @@ llvm::Constant* Compiler::makeLlvmZero(llvm::Type *llvmType, TypeTable::Id typeI
             llvm::Constant *elemLlvmZero = elem.noZeroInit ? llvm::UndefValue::get(elemLlvmType) : makeLlvmZero(elemLlvmType, elem.type);
             elemVals.push_back(elemLlvmZero);
         }
+        if (dataType.alignment > 0) elemVals.push_back(llvm::Constant::getNullValue(makeLlvmAlignmentPad(dataType.alignment)));
 
         llvmZero = llvm::ConstantStruct::get((llvm::StructType*) llvmType, elemVals);
     } else {
@@ -1130,17 +1818,210 @@ llvm::Constant* Compiler::makeLlvmZero(llvm::Type *llvmType, TypeTable::Id typeI
 llvm::GlobalValue* Compiler::makeLlvmGlobal(llvm::Type *type, llvm::Constant *init, bool isConstant, const std::string &name) {
     if (init == nullptr) init = llvm::Constant::getNullValue(type);
 
-    return new llvm::GlobalVariable(
+    llvm::GlobalVariable *llvmGlobal = new llvm::GlobalVariable(
         *llvmModule,
         type,
         isConstant,
         llvm::GlobalValue::PrivateLinkage,
         init,
         name);
+    setLlvmGlobalAlign(llvmGlobal);
+    return llvmGlobal;
+}
+
+bool Compiler::isFromInterface(CodeLoc codeLoc) const {
+    const SourceFile *src = sourceManager->find(codeLoc);
+    return src != nullptr && interfaceFiles.find(src->getFile()) != interfaceFiles.end();
+}
+
+llvm::GlobalValue* Compiler::makeLlvmGlobalForVar(CodeLoc codeLoc, llvm::Type *type, llvm::Constant *init, bool isConstant, const std::string &name) {
+    bool fromInterface = isFromInterface(codeLoc);
+    if (!emitInterface && !fromInterface) return makeLlvmGlobal(type, init, isConstant, name);
+
+    // defined in the object of the interface,
+    // otherwise visible to other objects so that programs importing the interface of this one can refer to it
+    if (fromInterface) init = nullptr;
+    else if (init == nullptr) init = llvm::Constant::getNullValue(type);
+
+    llvm::GlobalVariable *llvmGlobal = new llvm::GlobalVariable(
+        *llvmModule,
+        type,
+        isConstant,
+        fromInterface ? llvm::GlobalValue::ExternalLinkage : llvm::GlobalValue::WeakODRLinkage,
+        init,
+        name);
+    setLlvmGlobalAlign(llvmGlobal);
+    return llvmGlobal;
 }
 
 llvm::AllocaInst* Compiler::makeLlvmAlloca(llvm::Type *type, const std::string &name) {
-    return llvmBuilderAlloca.CreateAlloca(type, nullptr, name);
+    llvm::AllocaInst *llvmAlloca = llvmBuilderAlloca.CreateAlloca(type, nullptr, name);
+    llvmAlloca->setAlignment(max(llvmAlloca->getAlign(), getLlvmAlign(type)));
+    return llvmAlloca;
+}
+
+llvm::Align Compiler::getLlvmAlign(llvm::Type *type) {
+    // without the target, nothing can be assumed
+    if (targetMachine == nullptr && !initLlvmTargetMachine()) return llvm::Align(1);
+
+    return llvmModule->getDataLayout().getABITypeAlign(type);
+}
+
+void Compiler::setLlvmGlobalAlign(llvm::GlobalVariable *llvmGlobal) {
+    if (targetMachine == nullptr && !initLlvmTargetMachine()) return;
+
+    llvmGlobal->setAlignment(llvmModule->getDataLayout().getPreferredAlign(llvmGlobal));
+}
+
+llvm::Align Compiler::getLlvmRefAlign(const LlvmVal &llvmVal) {
+    if (llvmVal.refAlign.hasValue()) return llvmVal.refAlign.getValue();
+    return getLlvmAlign(llvmVal.ref->getType()->getPointerElementType());
+}
+
+llvm::MaybeAlign Compiler::getLlvmMemberRefAlign(const LlvmVal &base, llvm::Type *memberType, std::uint64_t memberOffset) {
+    llvm::Align align = llvm::commonAlignment(getLlvmRefAlign(base), memberOffset);
+    if (align >= getLlvmAlign(memberType)) return llvm::MaybeAlign();
+    return align;
+}
+
+llvm::LoadInst* Compiler::makeLlvmLoad(llvm::Value *llvmRef, llvm::Align align, const std::string &name) {
+    return llvmBuilder.CreateAlignedLoad(llvmRef->getType()->getPointerElementType(), llvmRef, align, name);
+}
+
+llvm::StoreInst* Compiler::makeLlvmStore(llvm::Value *llvmVal, llvm::Value *llvmRef, llvm::Align align) {
+    return llvmBuilder.CreateAlignedStore(llvmVal, llvmRef, align);
+}
+
+void Compiler::makeLlvmDropFlag(llvm::Value *llvmRef) {
+    DropFlag dropFlag;
+    dropFlag.llvmFlag = makeLlvmAlloca(makeLlvmPrimType(TypeTable::P_BOOL), "drop_flag");
+    llvmBuilder.CreateStore(getLlvmConstB(true), dropFlag.llvmFlag);
+
+    llvmDropFlags[llvmRef] = move(dropFlag);
+}
+
+void Compiler::markLlvmAddrTaken(llvm::Value *llvmRef) {
+    // find the variable this ref points into
+    while (true) {
+        if (llvm::GEPOperator *llvmGep = llvm::dyn_cast<llvm::GEPOperator>(llvmRef)) llvmRef = llvmGep->getPointerOperand();
+        else if (llvm::BitCastOperator *llvmCast = llvm::dyn_cast<llvm::BitCastOperator>(llvmRef)) llvmRef = llvmCast->getOperand(0);
+        else break;
+    }
+
+    auto loc = llvmDropFlags.find(llvmRef);
+    if (loc == llvmDropFlags.end() || loc->second.addrTaken) return;
+
+    // the variable may now get written to through pointers, so it must always be dropped
+    for (llvm::StoreInst *llvmStore : loc->second.llvmMovedStores) llvmStore->eraseFromParent();
+    loc->second.llvmMovedStores.clear();
+    loc->second.addrTaken = true;
+}
+
+CodeLocPoint Compiler::getCodeLocPoint(CodeLoc codeLoc) const {
+    const SourceFile *src = sourceManager->find(codeLoc);
+    if (src == nullptr) return CodeLocPoint{0, 0};
+
+    return src->getPoint(codeLoc.start);
+}
+
+llvm::DIFile* Compiler::makeLlvmDiFile(CodeLoc codeLoc) {
+    const SourceFile *src = sourceManager->find(codeLoc);
+    if (src == nullptr) return llvmDiCompileUnit->getFile();
+    StringPool::Id file = src->getFile();
+
+    auto loc = llvmDiFiles.find(file);
+    if (loc != llvmDiFiles.end()) return loc->second;
+
+    filesystem::path path(stringPool->get(file));
+    llvm::DIFile *llvmDiFile = llvmDiBuilder->createFile(path.filename().string(), path.parent_path().string());
+    llvmDiFiles.insert(make_pair(file, llvmDiFile));
+    return llvmDiFile;
+}
+
+llvm::DISubprogram* Compiler::makeLlvmDiSubprogram(CodeLoc codeLoc, NamePool::Id name, const std::string &linkageName) {
+    llvm::DIFile *llvmDiFile = makeLlvmDiFile(codeLoc);
+    CodeLocPoint start = getCodeLocPoint(codeLoc);
+
+    return llvmDiBuilder->createFunction(
+        llvmDiFile, namePool->get(name), linkageName, llvmDiFile, start.ln,
+        llvmDiBuilder->createSubroutineType(llvmDiBuilder->getOrCreateTypeArray({})), start.ln,
+        llvm::DINode::FlagZero, llvm::DISubprogram::SPFlagDefinition);
+}
+
+llvm::DIType* Compiler::makeLlvmDiType(TypeTable::Id typeId) {
+    unsigned encoding;
+    if (typeTable->worksAsTypeB(typeId)) encoding = llvm::dwarf::DW_ATE_boolean;
+    else if (typeTable->worksAsTypeI(typeId)) encoding = llvm::dwarf::DW_ATE_signed;
+    else if (typeTable->worksAsTypeU(typeId)) encoding = llvm::dwarf::DW_ATE_unsigned;
+    else if (typeTable->worksAsTypeF(typeId)) encoding = llvm::dwarf::DW_ATE_float;
+    else if (typeTable->worksAsTypeC(typeId)) encoding = llvm::dwarf::DW_ATE_signed_char;
+    else return nullptr;
+
+    optional<NamePool::Id> name = typeTable->getTypeName(typeId);
+    if (!name.has_value()) return nullptr;
+
+    llvm::Type *llvmType = makeLlvmType(typeId);
+    if (llvmType == nullptr) return nullptr;
+    if (targetMachine == nullptr && !initLlvmTargetMachine()) return nullptr;
+
+    std::uint64_t sizeInBits = llvmModule->getDataLayout().getTypeAllocSizeInBits(llvmType).getFixedSize();
+    return llvmDiBuilder->createBasicType(namePool->get(name.value()), sizeInBits, encoding);
+}
+
+static bool isCodeLocWithin(CodeLoc codeLoc, CodeLoc outer) {
+    return codeLoc.start >= outer.start && codeLoc.start < outer.end();
+}
+
+llvm::DILocation* Compiler::makeLlvmDebugLoc(CodeLoc codeLoc) {
+    if (llvmDiBuilder == nullptr || llvmBuilder.GetInsertBlock() == nullptr) return nullptr;
+
+    llvm::DIScope *llvmDiScope = getLlvmCurrFunction()->getSubprogram();
+    if (llvmDiScope == nullptr) return nullptr;
+    llvm::DILocation *llvmDiInlinedAt = nullptr;
+
+    for (auto it = debugExpansions.rbegin(); it != debugExpansions.rend(); ++it) {
+        if (it->llvmDiInlinedAt != nullptr && isCodeLocWithin(codeLoc, it->codeLocBody)) {
+            llvmDiScope = it->llvmDiMacro;
+            llvmDiInlinedAt = it->llvmDiInlinedAt;
+            break;
+        }
+    }
+
+    // eg. function bodies containing code from macro arguments written in another file
+    llvm::DIFile *llvmDiFile = makeLlvmDiFile(codeLoc);
+    if (llvmDiScope->getFile() != llvmDiFile) {
+        llvmDiScope = llvmDiBuilder->createLexicalBlockFile(llvmDiScope, llvmDiFile);
+    }
+
+    CodeLocPoint start = getCodeLocPoint(codeLoc);
+    return llvm::DILocation::get(llvmContext, start.ln, start.col, llvmDiScope, llvmDiInlinedAt);
+}
+
+void Compiler::setLlvmDebugLoc(CodeLoc codeLoc) {
+    if (llvmDiBuilder == nullptr) return;
+
+    llvmBuilder.SetCurrentDebugLocation(makeLlvmDebugLoc(codeLoc));
+}
+
+void Compiler::declareLlvmDebugVar(CodeLoc codeLoc, NamePool::Id name, TypeTable::Id typeId, llvm::Value *llvmRef, unsigned argNo) {
+    if (!debugInfoFull) return;
+
+    llvm::DILocation *llvmDiLoc = makeLlvmDebugLoc(codeLoc);
+    if (llvmDiLoc == nullptr) return;
+
+    llvm::DIType *llvmDiType = makeLlvmDiType(typeId);
+    if (llvmDiType == nullptr) return;
+
+    llvm::DILocalVariable *llvmDiVar;
+    if (argNo > 0) {
+        llvmDiVar = llvmDiBuilder->createParameterVariable(
+            llvmDiLoc->getScope(), namePool->get(name), argNo, llvmDiLoc->getFile(), llvmDiLoc->getLine(), llvmDiType);
+    } else {
+        llvmDiVar = llvmDiBuilder->createAutoVariable(
+            llvmDiLoc->getScope(), namePool->get(name), llvmDiLoc->getFile(), llvmDiLoc->getLine(), llvmDiType);
+    }
+
+    llvmDiBuilder->insertDeclare(llvmRef, llvmDiVar, llvmDiBuilder->createExpression(), llvmDiLoc, llvmBuilder.GetInsertBlock());
 }
 
 llvm::Value* Compiler::makeLlvmCast(llvm::Value *srcLlvmVal, TypeTable::Id srcTypeId, TypeTable::Id dstTypeId) {
@@ -1269,6 +2150,39 @@ llvm::Value* Compiler::makeLlvmCast(llvm::Value *srcLlvmVal, TypeTable::Id srcTy
     return dstLlvmVal;
 }
 
+bool Compiler::runLlvmFunctionPasses() {
+    // private functions are only reachable from this module,
+    // so ones that were never referenced (eg. unused library functions) can be skipped entirely
+    bool erased;
+    do {
+        erased = false;
+        for (auto it = llvmModule->begin(); it != llvmModule->end();) {
+            llvm::Function &llvmFunc = *it++;
+            if (!llvmFunc.hasPrivateLinkage()) continue;
+
+            llvmFunc.removeDeadConstantUsers();
+            if (llvmFunc.use_empty()) {
+                llvmFunc.eraseFromParent();
+                erased = true;
+            }
+        }
+    } while (erased);
+
+    for (llvm::Function &llvmFunc : *llvmModule) {
+        if (llvmFunc.isDeclaration()) continue;
+
+        // malformed code could crash or silently miscompile later on
+        if (llvm::verifyFunction(llvmFunc, &llvm::errs())) {
+            cerr << endl;
+            msgs->errorInternalBadCode(llvmFunc.getName().str());
+            return false;
+        }
+        llvmFpm->run(llvmFunc);
+    }
+
+    return true;
+}
+
 bool Compiler::initLlvmTargetMachine() {
     if (targetMachine != nullptr) return true;
 
@@ -1,6 +1,10 @@
 #pragma once
 
 #include <string>
+#include <unordered_map>
+#include <unordered_set>
+#include <vector>
+#include "llvm/IR/DIBuilder.h"
 #include "llvm/IR/IRBuilder.h"
 #include "llvm/IR/LegacyPassManager.h"
 #include "llvm/IR/LLVMContext.h"
@@ -8,8 +12,10 @@
 #include "llvm/Transforms/IPO/PassManagerBuilder.h"
 #include "Processor.h"
 #include "ProgramArgs.h"
+#include "SourceManager.h"
 
 class Compiler : public Processor {
+    SourceManager *sourceManager;
     llvm::LLVMContext llvmContext;
     llvm::IRBuilder<> llvmBuilder, llvmBuilderAlloca;
     std::unique_ptr<llvm::Module> llvmModule;
@@ -17,25 +23,105 @@ class Compiler : public Processor {
     std::unique_ptr<llvm::legacy::FunctionPassManager> llvmFpm;
     llvm::TargetMachine *targetMachine;
     bool link = false;
+    // the object may be linked along with others importing its interface
+    bool emitInterface = false;
+    bool fastMathAll = false;
+    ProgramArgs::LtoKind lto = ProgramArgs::LTO_NONE;
+    // code in these files was already compiled into an object that will get linked in
+    std::unordered_set<StringPool::Id, StringPool::Id::Hasher> interfaceFiles;
+
+    bool isFromInterface(CodeLoc codeLoc) const;
+
+    struct DropFlag {
+        llvm::AllocaInst *llvmFlag = nullptr;
+        // stores marking the variable as moved from, erased if its address gets taken
+        std::vector<llvm::StoreInst*> llvmMovedStores;
+        bool addrTaken = false;
+    };
+    // drop flags of local variables with non-trivial drops in the current function, keyed by their refs
+    std::unordered_map<llvm::Value*, DropFlag> llvmDropFlags;
+
+    // only set up when emitting debug info
+    std::unique_ptr<llvm::DIBuilder> llvmDiBuilder;
+    llvm::DICompileUnit *llvmDiCompileUnit = nullptr;
+    bool debugInfoFull = false;
+    std::unordered_map<StringPool::Id, llvm::DIFile*, StringPool::Id::Hasher> llvmDiFiles;
+    // scopes of inlined macro bodies, keyed by their body
+    std::unordered_map<const NodeVal*, llvm::DISubprogram*> llvmDiMacros;
+
+    struct DebugExpansion {
+        CodeLoc codeLocBody;
+        llvm::DISubprogram *llvmDiMacro;
+        // location of the invocation, null if outside of a function
+        llvm::DILocation *llvmDiInlinedAt;
+    };
+    // macro invocations being compiled in the current function, innermost last
+    std::vector<DebugExpansion> debugExpansions;
 
     bool initLlvmTargetMachine();
+    // erases unreferenced private functions, then verifies and optimizes the rest
+    bool runLlvmFunctionPasses();
 
     bool isLlvmBlockTerminated() const;
     llvm::Function* getLlvmCurrFunction() { return llvmBuilder.GetInsertBlock()->getParent(); }
     llvm::Constant* getLlvmConstB(bool val);
     // generates a constant for a string literal
     llvm::Constant* makeLlvmConstString(const std::string &str);
-    llvm::FunctionType* makeLlvmFunctionType(TypeTable::Id typeId);
+    llvm::FunctionType* makeLlvmFunctionType(TypeTable::Id typeId, bool byRefAbi);
+    // aggregates larger than this many bytes are passed as pointers to caller-owned copies and returned through sret
+    static constexpr std::uint64_t byRefAggregateThreshold = 16;
+    bool isLlvmPassedByRef(TypeTable::Id typeId);
+    bool isLlvmRetByRef(const TypeTable::Callable &callable);
+    bool hasLlvmByRefArgOrRet(const TypeTable::Callable &callable);
+    // functions with no name mangling are seen by foreign code, so they keep aggregates by value
+    bool hasLlvmByRefAbi(const FuncValue &func) const { return !func.noNameMangle; }
+    // function values always use the by-ref ABI, so those without it get loaded through a thunk
+    llvm::Function* getLlvmByRefAbiFunc(const FuncValue &func);
+    template <typename T>
+    void addLlvmByRefAttrs(T *llvmFuncOrCall, const TypeTable::Callable &callable);
+    NodeVal makeLlvmCall(CodeLoc codeLoc, CodeLoc codeLocFunc, const NodeVal &func, const std::vector<NodeVal> &args, bool byRefAbi);
     llvm::Type* makeLlvmType(TypeTable::Id typeId);
     llvm::Type* makeLlvmPrimType(TypeTable::PrimIds primTypeId) { return makeLlvmType(typeTable->getPrimTypeId(primTypeId)); }
     llvm::Type* makeLlvmTypeOrError(CodeLoc codeLoc, TypeTable::Id typeId);
+    // zero-sized, but aligned to the given alignment
+    llvm::Type* makeLlvmAlignmentPad(std::uint64_t alignment);
+    bool isLlvmAlignmentPadSupported(std::uint64_t alignment);
     llvm::Constant* makeLlvmZero(TypeTable::Id typeId);
     llvm::Constant* makeLlvmZero(llvm::Type *llvmType, TypeTable::Id typeId);
     llvm::GlobalValue* makeLlvmGlobal(llvm::Type *type, llvm::Constant *init, bool isConstant, const std::string &name);
+    llvm::GlobalValue* makeLlvmGlobalForVar(CodeLoc codeLoc, llvm::Type *type, llvm::Constant *init, bool isConstant, const std::string &name);
     llvm::AllocaInst* makeLlvmAlloca(llvm::Type *type, const std::string &name);
+    // the alignment of the type in memory, as laid out for the target
+    llvm::Align getLlvmAlign(llvm::Type *type);
+    // made explicit, so that it does not depend on the defaults of the backend
+    void setLlvmGlobalAlign(llvm::GlobalVariable *llvmGlobal);
+    llvm::Align getLlvmRefAlign(const LlvmVal &llvmVal);
+    // members of packed data, and anything within them, may be less aligned than their types
+    llvm::MaybeAlign getLlvmMemberRefAlign(const LlvmVal &base, llvm::Type *memberType, std::uint64_t memberOffset);
+    // accesses are always given their alignment, instead of assuming that of the type
+    llvm::LoadInst* makeLlvmLoad(llvm::Value *llvmRef, llvm::Align align, const std::string &name);
+    llvm::StoreInst* makeLlvmStore(llvm::Value *llvmVal, llvm::Value *llvmRef, llvm::Align align);
+    void makeLlvmDropFlag(llvm::Value *llvmRef);
+    void markLlvmAddrTaken(llvm::Value *llvmRef);
     llvm::Value* makeLlvmCast(llvm::Value *srcLlvmVal, TypeTable::Id srcTypeId, TypeTable::Id dstTypeId);
     llvm::Value* makeLlvmCast(llvm::Value *srcLlvmVal, TypeTable::Id srcTypeId, llvm::Type *dstLlvmType, TypeTable::Id dstTypeId);
 
+    CodeLocPoint getCodeLocPoint(CodeLoc codeLoc) const;
+    // falls back to the file of the compile unit for code locs outside of source files
+    llvm::DIFile* makeLlvmDiFile(CodeLoc codeLoc);
+    llvm::DISubprogram* makeLlvmDiSubprogram(CodeLoc codeLoc, NamePool::Id name, const std::string &linkageName);
+    // returns nullptr for types without a debug info description
+    llvm::DIType* makeLlvmDiType(TypeTable::Id typeId);
+    // attributes code inside of macro bodies to the invocation site
+    llvm::DILocation* makeLlvmDebugLoc(CodeLoc codeLoc);
+    // sets the location of all following instructions, if emitting debug info
+    void setLlvmDebugLoc(CodeLoc codeLoc);
+    // argNo is 1-based, 0 for local variables
+    void declareLlvmDebugVar(CodeLoc codeLoc, NamePool::Id name, TypeTable::Id typeId, llvm::Value *llvmRef, unsigned argNo);
+
+    // combines given attributes with -ffast-math
+    llvm::FastMathFlags makeLlvmFastMathFlags(FastMathAttrs fastMath) const;
+
     std::string getNameForLlvm(NamePool::Id name) const;
     // handles name mangling
     std::optional<std::string> getFuncNameForLlvm(const FuncValue &func);
@@ -59,10 +145,15 @@ class Compiler : public Processor {
     bool performExit(CodeLoc codeLoc, SymbolTable::Block block, const NodeVal &cond) override;
     bool performLoop(CodeLoc codeLoc, SymbolTable::Block block, const NodeVal &cond) override;
     bool performPass(CodeLoc codeLoc, SymbolTable::Block block, NodeVal val) override;
+    bool performMovedFrom(CodeLoc codeLoc, VarId varId) override;
+    DropGuardSignal performDropGuardSetUp(CodeLoc codeLoc, VarId varId) override;
+    bool performDropGuardTearDown(CodeLoc codeLoc, DropGuardSignal signal) override;
     bool performDataDefinition(CodeLoc codeLoc, TypeTable::Id ty) override;
     NodeVal performCall(CodeLoc codeLoc, CodeLoc codeLocFunc, const NodeVal &func, const std::vector<NodeVal> &args) override;
     NodeVal performCall(CodeLoc codeLoc, CodeLoc codeLocFunc, FuncId funcId, const std::vector<NodeVal> &args) override;
     NodeVal performInvoke(CodeLoc codeLoc, MacroId macroId, std::vector<NodeVal> args) override;
+    bool performExpansionSetUp(CodeLoc codeLoc, MacroId macroId) override;
+    bool performExpansionTearDown(CodeLoc codeLoc) override;
     bool performFunctionDeclaration(CodeLoc codeLoc, FuncValue &func) override;
     bool performFunctionDefinition(CodeLoc codeLoc, const NodeVal &args, const NodeVal &body, FuncValue &func) override;
     bool performMacroDefinition(CodeLoc codeLoc, const NodeVal &args, const NodeVal &body, MacroValue &macro) override;
@@ -71,7 +162,7 @@ class Compiler : public Processor {
     NodeVal performOperUnary(CodeLoc codeLoc, NodeVal oper, Oper op) override;
     NodeVal performOperUnaryDeref(CodeLoc codeLoc, const NodeVal &oper, TypeTable::Id resTy) override;
     ComparisonSignal performOperComparisonSetUp(CodeLoc codeLoc, std::size_t opersCnt) override;
-    std::optional<bool> performOperComparison(CodeLoc codeLoc, const NodeVal &lhs, const NodeVal &rhs, Oper op, ComparisonSignal &signal) override;
+    std::optional<bool> performOperComparison(CodeLoc codeLoc, const NodeVal &lhs, const NodeVal &rhs, Oper op, FastMathAttrs fastMath, ComparisonSignal &signal) override;
     NodeVal performOperComparisonTearDown(CodeLoc codeLoc, bool success, ComparisonSignal signal) override;
     NodeVal performOperAssignment(CodeLoc codeLoc, const NodeVal &lhs, NodeVal rhs) override;
     NodeVal performOperIndexArr(CodeLoc codeLoc, NodeVal &base, const NodeVal &ind, TypeTable::Id resTy) override;
@@ -80,7 +171,7 @@ class Compiler : public Processor {
     std::optional<std::uint64_t> performSizeOf(CodeLoc codeLoc, TypeTable::Id ty) override;
 
 public:
-    Compiler(NamePool *namePool, StringPool *stringPool, TypeTable *typeTable, SymbolTable *symbolTable, CompilationMessages *msgs, const ProgramArgs &args);
+    Compiler(NamePool *namePool, StringPool *stringPool, SourceManager *sourceManager, TypeTable *typeTable, SymbolTable *symbolTable, CompilationMessages *msgs, const ProgramArgs &args);
 
     llvm::Type* genPrimTypeBool();
     llvm::Type* genPrimTypeI(unsigned bits);
@@ -90,6 +181,11 @@ public:
     llvm::Type* genPrimTypeF64();
     llvm::Type* genPrimTypePtr();
 
+    void addInterfaceFile(StringPool::Id file) { interfaceFiles.insert(file); }
+
     void printout(const std::string &filename) const;
+    void printoutBc(const std::string &filename) const;
     bool binary(const std::string &filename);
+    // compiles each function into its own object in dir, reusing objects of previous compilations
+    bool binaryCached(const std::string &dir, std::vector<std::string> &objFiles);
 };
\ No newline at end of file
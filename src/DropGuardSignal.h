@@ -0,0 +1,8 @@
+#pragma once
+
+#include "llvm/IR/Instructions.h"
+
+struct DropGuardSignal {
+    bool guarded = false;
+    llvm::BasicBlock *llvmBlockAfter = nullptr;
+};
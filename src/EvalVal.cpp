@@ -4,12 +4,22 @@
 #include "SymbolTable.h"
 using namespace std;
 
+void EvalVal::setRef(Pointer ref) {
+    if (!cold.isAllocated() && isNull(ref)) return;
+    cold.get().ref = ref;
+}
+
 void EvalVal::removeRef() {
-    ref = nullptr;
+    setRef(nullptr);
+}
+
+void EvalVal::setLifetimeInfo(LifetimeInfo lifetimeInfo) {
+    if (!cold.isAllocated() && lifetimeInfo.isDefault()) return;
+    cold.get().lifetimeInfo = lifetimeInfo;
 }
 
 optional<VarId> EvalVal::getVarId() const {
-    if (holds_alternative<VarId>(ref)) return get<VarId>(ref);
+    if (holds_alternative<VarId>(getRef())) return get<VarId>(getRef());
     return nullopt;
 }
 
@@ -22,7 +32,7 @@ EvalVal EvalVal::makeVal(TypeTable::Id t, TypeTable *typeTable) {
     } else if (typeTable->worksAsPrimitive(t, TypeTable::P_TYPE)) {
         evalVal.value = TypeTable::Id();
     } else if (typeTable->worksAsTypeP(t)) {
-        evalVal.value = Pointer(nullptr);
+        evalVal.value = Boxed<Pointer>();
     } else if (typeTable->worksAsTypeStr(t)) {
         evalVal.value = optional<StringPool::Id>();
     } else if (typeTable->worksAsCallable(t, true)) {
@@ -30,11 +40,11 @@ EvalVal EvalVal::makeVal(TypeTable::Id t, TypeTable *typeTable) {
     } else if (typeTable->worksAsCallable(t, false)) {
         evalVal.value = optional<MacroId>();
     } else if (typeTable->worksAsPrimitive(t, TypeTable::P_RAW)) {
-        evalVal.value = vector<NodeVal>();
+        evalVal.value = Boxed<pmr::vector<NodeVal>>();
     } else if (typeTable->worksAsTuple(t)) {
         const TypeTable::Tuple *tup = typeTable->extractTuple(t);
 
-        evalVal.value = vector<NodeVal>();
+        evalVal.value = Boxed<pmr::vector<NodeVal>>();
         evalVal.elems().reserve(tup->elements.size());
         for (TypeTable::Id elem : tup->elements) {
             evalVal.elems().push_back(NodeVal(CodeLoc(), makeVal(elem, typeTable)));
@@ -42,7 +52,7 @@ EvalVal EvalVal::makeVal(TypeTable::Id t, TypeTable *typeTable) {
     } else if (typeTable->worksAsDataType(t)) {
         const TypeTable::DataType *data = typeTable->extractDataType(t);
 
-        evalVal.value = vector<NodeVal>();
+        evalVal.value = Boxed<pmr::vector<NodeVal>>();
         evalVal.elems().reserve(data->elements.size());
         for (const auto &elem : data->elements) {
             evalVal.elems().push_back(NodeVal(CodeLoc(), makeVal(elem.type, typeTable)));
@@ -51,7 +61,7 @@ EvalVal EvalVal::makeVal(TypeTable::Id t, TypeTable *typeTable) {
         size_t len = typeTable->extractLenOfArr(t).value();
         TypeTable::Id elemType = typeTable->addTypeIndexOf(t).value();
 
-        evalVal.value = vector<NodeVal>(len, NodeVal(CodeLoc(), makeVal(elemType, typeTable)));
+        evalVal.value = Boxed<pmr::vector<NodeVal>>(pmr::vector<NodeVal>(len, NodeVal(CodeLoc(), makeVal(elemType, typeTable))));
     } else {
         evalVal.value = EasyZeroVals();
     }
@@ -59,6 +69,14 @@ EvalVal EvalVal::makeVal(TypeTable::Id t, TypeTable *typeTable) {
     return evalVal;
 }
 
+EvalVal EvalVal::makeRawIn(pmr::memory_resource *arena, TypeTable *typeTable) {
+    EvalVal evalVal;
+    evalVal.type = typeTable->getPrimTypeId(TypeTable::P_RAW);
+    evalVal.value = Boxed<pmr::vector<NodeVal>>(pmr::vector<NodeVal>(arena), arena);
+
+    return evalVal;
+}
+
 EvalVal EvalVal::makeZero(TypeTable::Id t, NamePool *namePool, TypeTable *typeTable) {
     EvalVal evalVal;
     evalVal.type = t;
@@ -68,7 +86,7 @@ EvalVal EvalVal::makeZero(TypeTable::Id t, NamePool *namePool, TypeTable *typeTa
     } else if (typeTable->worksAsPrimitive(t, TypeTable::P_TYPE)) {
         evalVal.value = typeTable->getPrimTypeId(TypeTable::P_ID);
     } else if (typeTable->worksAsTypeP(t)) {
-        evalVal.value = Pointer(nullptr);
+        evalVal.value = Boxed<Pointer>();
     } else if (typeTable->worksAsTypeStr(t)) {
         evalVal.value = optional<StringPool::Id>();
     } else if (typeTable->worksAsCallable(t, true)) {
@@ -76,11 +94,11 @@ EvalVal EvalVal::makeZero(TypeTable::Id t, NamePool *namePool, TypeTable *typeTa
     } else if (typeTable->worksAsCallable(t, false)) {
         evalVal.value = optional<MacroId>();
     } else if (typeTable->worksAsPrimitive(t, TypeTable::P_RAW)) {
-        evalVal.value = vector<NodeVal>();
+        evalVal.value = Boxed<pmr::vector<NodeVal>>();
     } else if (typeTable->worksAsTuple(t)) {
         const TypeTable::Tuple *tup = typeTable->extractTuple(t);
 
-        evalVal.value = vector<NodeVal>();
+        evalVal.value = Boxed<pmr::vector<NodeVal>>();
         evalVal.elems().reserve(tup->elements.size());
         for (TypeTable::Id elem : tup->elements) {
             evalVal.elems().push_back(NodeVal(CodeLoc(), makeZero(elem, namePool, typeTable)));
@@ -88,7 +106,7 @@ EvalVal EvalVal::makeZero(TypeTable::Id t, NamePool *namePool, TypeTable *typeTa
     } else if (typeTable->worksAsDataType(t)) {
         const TypeTable::DataType *data = typeTable->extractDataType(t);
 
-        evalVal.value = vector<NodeVal>();
+        evalVal.value = Boxed<pmr::vector<NodeVal>>();
         evalVal.elems().reserve(data->elements.size());
         for (const auto &elem : data->elements) {
             evalVal.elems().push_back(NodeVal(CodeLoc(), makeZero(elem.type, namePool, typeTable)));
@@ -97,7 +115,7 @@ EvalVal EvalVal::makeZero(TypeTable::Id t, NamePool *namePool, TypeTable *typeTa
         size_t len = typeTable->extractLenOfArr(t).value();
         TypeTable::Id elemType = typeTable->addTypeIndexOf(t).value();
 
-        evalVal.value = vector<NodeVal>(len, NodeVal(CodeLoc(), makeZero(elemType, namePool, typeTable)));
+        evalVal.value = Boxed<pmr::vector<NodeVal>>(pmr::vector<NodeVal>(len, NodeVal(CodeLoc(), makeZero(elemType, namePool, typeTable))));
     } else {
         evalVal.value = EasyZeroVals();
     }
@@ -108,13 +126,13 @@ EvalVal EvalVal::makeZero(TypeTable::Id t, NamePool *namePool, TypeTable *typeTa
 EvalVal EvalVal::copyNoRef(const EvalVal &k, LifetimeInfo lifetimeInfo) {
     EvalVal evalVal(k);
     evalVal.removeRef();
-    evalVal.lifetimeInfo = lifetimeInfo;
+    evalVal.setLifetimeInfo(lifetimeInfo);
     return evalVal;
 }
 
 EvalVal EvalVal::moveNoRef(EvalVal &&k, LifetimeInfo lifetimeInfo) {
     k.removeRef();
-    k.lifetimeInfo = lifetimeInfo;
+    k.setLifetimeInfo(lifetimeInfo);
     return std::move(k);
 }
 
@@ -221,7 +239,7 @@ NodeVal& EvalVal::getPointee(const EvalVal &val, SymbolTable *symbolTable) {
 }
 
 NodeVal& EvalVal::getRefee(const EvalVal &val, SymbolTable *symbolTable) {
-    return deref(val.ref, symbolTable);
+    return deref(val.getRef(), symbolTable);
 }
 
 optional<int64_t> EvalVal::getValueI(const EvalVal &val, const TypeTable *typeTable) {
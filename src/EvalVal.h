@@ -1,8 +1,10 @@
 #pragma once
 
+#include <memory_resource>
 #include <optional>
 #include <variant>
 #include <vector>
+#include "Boxed.h"
 #include "EscapeScore.h"
 #include "LifetimeInfo.h"
 #include "NamePool.h"
@@ -43,22 +45,27 @@ private:
         }
     };
 
+    // only set on values referring to something or stored in variables
+    struct Cold {
+        Pointer ref = nullptr;
+        LifetimeInfo lifetimeInfo;
+    };
+
     TypeTable::Id type;
+    EscapeScore escapeScore = 0;
 
+    // larger payloads are boxed, so that each alternative takes at most two words
     std::variant<
         EasyZeroVals,
         NamePool::Id,
         TypeTable::Id,
-        Pointer,
+        Boxed<Pointer>,
         std::optional<StringPool::Id>,
         std::optional<FuncId>,
         std::optional<MacroId>,
-        std::vector<NodeVal>> value;
+        Boxed<std::pmr::vector<NodeVal>>> value;
 
-    Pointer ref = nullptr;
-    LifetimeInfo lifetimeInfo;
-
-    EscapeScore escapeScore = 0;
+    Boxed<Cold> cold;
 
 public:
     // type of this evaluation value
@@ -107,8 +114,8 @@ public:
     // value of type 'type', contained within this evaluated value
     const TypeTable::Id& ty() const { return std::get<TypeTable::Id>(value); }
 
-    Pointer& p() { return std::get<Pointer>(value); }
-    const Pointer& p() const { return std::get<Pointer>(value); }
+    Pointer& p() { return std::get<Boxed<Pointer>>(value).get(); }
+    const Pointer& p() const { return std::get<Boxed<Pointer>>(value).get(); }
 
     std::optional<StringPool::Id>& str() { return std::get<std::optional<StringPool::Id>>(value); }
     const std::optional<StringPool::Id>& str() const { return std::get<std::optional<StringPool::Id>>(value); }
@@ -119,16 +126,16 @@ public:
     std::optional<MacroId>& m() { return std::get<std::optional<MacroId>>(value); }
     const std::optional<MacroId>& m() const { return std::get<std::optional<MacroId>>(value); }
 
-    std::vector<NodeVal>& elems() { return std::get<std::vector<NodeVal>>(value); }
-    const std::vector<NodeVal>& elems() const { return std::get<std::vector<NodeVal>>(value); }
+    std::pmr::vector<NodeVal>& elems() { return std::get<Boxed<std::pmr::vector<NodeVal>>>(value).get(); }
+    const std::pmr::vector<NodeVal>& elems() const { return std::get<Boxed<std::pmr::vector<NodeVal>>>(value).get(); }
 
-    bool hasRef() const { return !isNull(ref); }
-    Pointer& getRef() { return ref; }
-    const Pointer& getRef() const { return ref; }
+    bool hasRef() const { return !isNull(getRef()); }
+    const Pointer& getRef() const { return cold.get().ref; }
+    void setRef(Pointer ref);
     void removeRef();
 
-    LifetimeInfo& getLifetimeInfo() { return lifetimeInfo; }
-    const LifetimeInfo& getLifetimeInfo() const { return lifetimeInfo; }
+    const LifetimeInfo& getLifetimeInfo() const { return cold.get().lifetimeInfo; }
+    void setLifetimeInfo(LifetimeInfo lifetimeInfo);
 
     bool isEscaped() const { return escapeScore > 0; }
     EscapeScore getEscapeScore() const { return escapeScore; }
@@ -138,6 +145,8 @@ public:
 
     static EvalVal makeVal(TypeTable::Id t, TypeTable *typeTable);
     static EvalVal makeZero(TypeTable::Id t, NamePool *namePool, TypeTable *typeTable);
+    // empty raw value whose elements are kept in the arena, it must not outlive the arena
+    static EvalVal makeRawIn(std::pmr::memory_resource *arena, TypeTable *typeTable);
 
     // use NodeVal::copyNoRef unless sure attrs aren't needed
     static EvalVal copyNoRef(const EvalVal &k, LifetimeInfo lifetimeInfo);
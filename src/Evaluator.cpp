@@ -18,7 +18,7 @@ NodeVal Evaluator::performLoad(CodeLoc codeLoc, VarId varId) {
             return ref.var;
         } else {
             NodeVal nodeVal = NodeVal::copyNoRef(codeLoc, ref.var);
-            nodeVal.getEvalVal().getRef() = varId;
+            nodeVal.getEvalVal().setRef(varId);
             return nodeVal;
         }
     } else {
@@ -56,7 +56,9 @@ NodeVal Evaluator::performZero(CodeLoc codeLoc, TypeTable::Id ty) {
 
 NodeVal Evaluator::performRegister(CodeLoc codeLoc, NamePool::Id id, CodeLoc codeLocTy, TypeTable::Id ty) {
     EvalVal evalVal = EvalVal::makeZero(ty, namePool, typeTable);
-    evalVal.getLifetimeInfo().nestLevel = symbolTable->currNestLevel();
+    LifetimeInfo lifetimeInfo;
+    lifetimeInfo.nestLevel = symbolTable->currNestLevel();
+    evalVal.setLifetimeInfo(lifetimeInfo);
     return NodeVal(codeLoc, move(evalVal));
 }
 
@@ -152,6 +154,18 @@ bool Evaluator::performPass(CodeLoc codeLoc, SymbolTable::Block block, NodeVal v
     throw ex;
 }
 
+bool Evaluator::performMovedFrom(CodeLoc codeLoc, VarId varId) {
+    return true;
+}
+
+DropGuardSignal Evaluator::performDropGuardSetUp(CodeLoc codeLoc, VarId varId) {
+    return DropGuardSignal();
+}
+
+bool Evaluator::performDropGuardTearDown(CodeLoc codeLoc, DropGuardSignal signal) {
+    return true;
+}
+
 NodeVal Evaluator::performCall(CodeLoc codeLoc, CodeLoc codeLocFunc, const NodeVal &func, const std::vector<NodeVal> &args) {
     if (!checkIsEvalVal(func, true)) return NodeVal();
     if (!func.getEvalVal().f().has_value()) {
@@ -269,6 +283,14 @@ NodeVal Evaluator::performInvoke(CodeLoc codeLoc, MacroId macroId, std::vector<N
     return move(ret);
 }
 
+bool Evaluator::performExpansionSetUp(CodeLoc codeLoc, MacroId macroId) {
+    return true;
+}
+
+bool Evaluator::performExpansionTearDown(CodeLoc codeLoc) {
+    return true;
+}
+
 bool Evaluator::performFunctionDeclaration(CodeLoc codeLoc, FuncValue &func) {
     // mark the func as eval, but it cannot be called
     func.isEvalFunc = true;
@@ -383,7 +405,7 @@ NodeVal Evaluator::performOperUnaryDeref(CodeLoc codeLoc, const NodeVal &oper, T
 
     NodeVal nodeEvalVal = NodeVal::copyNoRef(codeLoc, EvalVal::getPointee(oper.getEvalVal(), symbolTable));
     nodeEvalVal.getEvalVal().getType() = resTy;
-    nodeEvalVal.getEvalVal().getRef() = oper.getEvalVal().p();
+    nodeEvalVal.getEvalVal().setRef(oper.getEvalVal().p());
     return nodeEvalVal;
 }
 
@@ -391,7 +413,7 @@ ComparisonSignal Evaluator::performOperComparisonSetUp(CodeLoc codeLoc, std::siz
     return ComparisonSignal();
 }
 
-optional<bool> Evaluator::performOperComparison(CodeLoc codeLoc, const NodeVal &lhs, const NodeVal &rhs, Oper op, ComparisonSignal &signal) {
+optional<bool> Evaluator::performOperComparison(CodeLoc codeLoc, const NodeVal &lhs, const NodeVal &rhs, Oper op, FastMathAttrs fastMath, ComparisonSignal &signal) {
     if (!checkIsEvalVal(lhs, true) || !checkIsEvalVal(rhs, true)) return nullopt;
 
     TypeTable::Id ty = lhs.getType().value();
@@ -618,7 +640,7 @@ NodeVal Evaluator::performOperAssignment(CodeLoc codeLoc, const NodeVal &lhs, No
     lhsRefee = NodeVal::copyNoRef(lhsRefee.getCodeLoc(), rhs, lhsLifetimeInfo);
 
     NodeVal nodeVal = NodeVal::moveNoRef(lhs.getCodeLoc(), move(rhs), lhsLifetimeInfo);
-    nodeVal.getEvalVal().getRef() = lhs.getEvalVal().getRef();
+    nodeVal.getEvalVal().setRef(lhs.getEvalVal().getRef());
     return nodeVal;
 }
 
@@ -636,7 +658,7 @@ NodeVal Evaluator::performOperIndexArr(CodeLoc codeLoc, NodeVal &base, const Nod
         nodeVal.getEvalVal().getType() = resTy;
         if (base.hasRef()) {
             NodeVal &baseRefee = EvalVal::getRefee(base.getEvalVal(), symbolTable);
-            nodeVal.getEvalVal().getRef() = &baseRefee.getEvalVal().elems()[index.value()];
+            nodeVal.getEvalVal().setRef(&baseRefee.getEvalVal().elems()[index.value()]);
         }
         return nodeVal;
     } else if (typeTable->worksAsTypeStr(base.getType().value())) {
@@ -673,9 +695,9 @@ NodeVal Evaluator::performOperIndex(CodeLoc codeLoc, NodeVal &base, std::uint64_
             nodeVal.getEvalVal().getType() = resTy;
             if (base.hasRef()) {
                 NodeVal &baseRefee = EvalVal::getRefee(base.getEvalVal(), symbolTable);
-                nodeVal.getEvalVal().getRef() = &baseRefee.getEvalVal().elems()[ind];
+                nodeVal.getEvalVal().setRef(&baseRefee.getEvalVal().elems()[ind]);
             } else {
-                nodeVal.getEvalVal().getRef() = nullptr;
+                nodeVal.getEvalVal().setRef(nullptr);
             }
         }
         if (base.isInvokeArg() && nodeVal.getLifetimeInfo().has_value()) {
@@ -689,7 +711,7 @@ NodeVal Evaluator::performOperIndex(CodeLoc codeLoc, NodeVal &base, std::uint64_
         nodeVal.getEvalVal().getType() = resTy;
         if (base.hasRef()) {
             NodeVal &baseRefee = EvalVal::getRefee(base.getEvalVal(), symbolTable);
-            nodeVal.getEvalVal().getRef() = &baseRefee.getEvalVal().elems()[ind];
+            nodeVal.getEvalVal().setRef(&baseRefee.getEvalVal().elems()[ind]);
         }
         return nodeVal;
     }
@@ -1005,8 +1027,9 @@ optional<NodeVal> Evaluator::makeCast(CodeLoc codeLoc, const NodeVal &srcVal, Ty
         }
     }
 
-    dstEvalVal.getLifetimeInfo() = LifetimeInfo();
-    dstEvalVal.getLifetimeInfo().noDrop = srcEvalVal.getLifetimeInfo().noDrop;
+    LifetimeInfo lifetimeInfo;
+    lifetimeInfo.noDrop = srcEvalVal.getLifetimeInfo().noDrop;
+    dstEvalVal.setLifetimeInfo(lifetimeInfo);
 
     return NodeVal(codeLoc, move(dstEvalVal));
 }
@@ -1042,8 +1065,8 @@ NamePool::Id Evaluator::makeIdConcat(NamePool::Id lhs, NamePool::Id rhs, bool ba
     return namePool->add(ss.str());
 }
 
-vector<NodeVal> Evaluator::makeRawConcat(const EvalVal &lhs, const EvalVal &rhs) const {
-    vector<NodeVal> elems;
+pmr::vector<NodeVal> Evaluator::makeRawConcat(const EvalVal &lhs, const EvalVal &rhs) const {
+    pmr::vector<NodeVal> elems;
     elems.reserve(lhs.elems().size()+rhs.elems().size());
 
     for (const auto &it : lhs.elems()) {
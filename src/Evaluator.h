@@ -23,7 +23,7 @@ class Evaluator : public Processor {
     NamePool::Id makeIdFromB(bool x);
     std::optional<NamePool::Id> makeIdFromTy(TypeTable::Id x);
     NamePool::Id makeIdConcat(NamePool::Id lhs, NamePool::Id rhs, bool bare);
-    std::vector<NodeVal> makeRawConcat(const EvalVal &lhs, const EvalVal &rhs) const;
+    std::pmr::vector<NodeVal> makeRawConcat(const EvalVal &lhs, const EvalVal &rhs) const;
 
     NodeVal doBlockTearDown(CodeLoc codeLoc, SymbolTable::Block block, bool success, bool jumpingOut);
 
@@ -41,10 +41,15 @@ public:
     bool performExit(CodeLoc codeLoc, SymbolTable::Block block, const NodeVal &cond) override;
     bool performLoop(CodeLoc codeLoc, SymbolTable::Block block, const NodeVal &cond) override;
     bool performPass(CodeLoc codeLoc, SymbolTable::Block block, NodeVal val) override;
+    bool performMovedFrom(CodeLoc codeLoc, VarId varId) override;
+    DropGuardSignal performDropGuardSetUp(CodeLoc codeLoc, VarId varId) override;
+    bool performDropGuardTearDown(CodeLoc codeLoc, DropGuardSignal signal) override;
     bool performDataDefinition(CodeLoc codeLoc, TypeTable::Id ty) override { return true; }
     NodeVal performCall(CodeLoc codeLoc, CodeLoc codeLocFunc, const NodeVal &func, const std::vector<NodeVal> &args) override;
     NodeVal performCall(CodeLoc codeLoc, CodeLoc codeLocFunc, FuncId funcId, const std::vector<NodeVal> &args) override;
     NodeVal performInvoke(CodeLoc codeLoc, MacroId macroId, std::vector<NodeVal> args) override;
+    bool performExpansionSetUp(CodeLoc codeLoc, MacroId macroId) override;
+    bool performExpansionTearDown(CodeLoc codeLoc) override;
     bool performFunctionDeclaration(CodeLoc codeLoc, FuncValue &func) override;
     bool performFunctionDefinition(CodeLoc codeLoc, const NodeVal &args, const NodeVal &body, FuncValue &func) override;
     bool performMacroDefinition(CodeLoc codeLoc, const NodeVal &args, const NodeVal &body, MacroValue &macro) override;
@@ -53,7 +58,7 @@ public:
     NodeVal performOperUnary(CodeLoc codeLoc, NodeVal oper, Oper op) override;
     NodeVal performOperUnaryDeref(CodeLoc codeLoc, const NodeVal &oper, TypeTable::Id resTy) override;
     ComparisonSignal performOperComparisonSetUp(CodeLoc codeLoc, std::size_t opersCnt) override;
-    std::optional<bool> performOperComparison(CodeLoc codeLoc, const NodeVal &lhs, const NodeVal &rhs, Oper op, ComparisonSignal &signal) override;
+    std::optional<bool> performOperComparison(CodeLoc codeLoc, const NodeVal &lhs, const NodeVal &rhs, Oper op, FastMathAttrs fastMath, ComparisonSignal &signal) override;
     NodeVal performOperComparisonTearDown(CodeLoc codeLoc, bool success, ComparisonSignal signal) override;
     NodeVal performOperAssignment(CodeLoc codeLoc, const NodeVal &lhs, NodeVal rhs) override;
     NodeVal performOperIndexArr(CodeLoc codeLoc, NodeVal &base, const NodeVal &ind, TypeTable::Id resTy) override;
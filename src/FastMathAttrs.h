@@ -0,0 +1,21 @@
+#pragma once
+
+struct FastMathAttrs {
+    bool fast = false;
+    bool reassoc = false;
+    bool contract = false;
+    bool nnan = false;
+    bool ninf = false;
+    bool arcp = false;
+
+    bool any() const { return fast || reassoc || contract || nnan || ninf || arcp; }
+
+    void merge(const FastMathAttrs &other) {
+        fast = fast || other.fast;
+        reassoc = reassoc || other.reassoc;
+        contract = contract || other.contract;
+        nnan = nnan || other.nnan;
+        ninf = ninf || other.ninf;
+        arcp = arcp || other.arcp;
+    }
+};
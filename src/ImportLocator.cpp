@@ -0,0 +1,77 @@
+#include "ImportLocator.h"
+#include "OrbCompilerConfig.h"
+#if PLATFORM_UNIX
+#include <sys/stat.h>
+#endif
+using namespace std;
+
+ImportLocator::ImportLocator(const vector<string> &importPaths) {
+    searchPaths.push_back(filesystem::path());
+    for (const string &path : importPaths) searchPaths.push_back(path);
+    searchPaths.push_back(ORBC_LIBS_PATH);
+}
+
+const optional<unordered_set<string>>& ImportLocator::listDir(const filesystem::path &dir) {
+    string key = dir.empty() ? "." : dir.string();
+
+    auto loc = dirEntries.find(key);
+    if (loc != dirEntries.end()) return loc->second;
+
+    optional<unordered_set<string>> entries;
+    error_code errorCode;
+    filesystem::directory_iterator it(key, errorCode);
+    if (!errorCode) {
+        entries.emplace();
+        for (; it != filesystem::directory_iterator(); it.increment(errorCode)) {
+            entries->insert(it->path().filename().string());
+        }
+    }
+
+    return dirEntries.insert(make_pair(key, move(entries))).first->second;
+}
+
+bool ImportLocator::exists(const filesystem::path &path) {
+    // . and .. are not listed
+    filesystem::path filename = path.filename();
+    if (filename.empty() || filename == "." || filename == "..") return filesystem::exists(path);
+
+    const optional<unordered_set<string>> &entries = listDir(path.parent_path());
+    return entries.has_value() && entries->find(filename.string()) != entries->end();
+}
+
+optional<string> ImportLocator::locate(const string &file) {
+    auto loc = located.find(file);
+    if (loc != located.end()) return loc->second;
+
+    optional<string> path;
+    if (filesystem::path(file).is_absolute()) {
+        if (exists(file)) path = identify(file);
+    } else {
+        for (const filesystem::path &searchPath : searchPaths) {
+            filesystem::path candidate = searchPath / file;
+            if (exists(candidate)) {
+                path = identify(candidate);
+                break;
+            }
+        }
+    }
+
+    located.insert(make_pair(file, path));
+    return path;
+}
+
+string ImportLocator::identify(const filesystem::path &path) {
+    string normalized = filesystem::absolute(path).lexically_normal().string();
+
+#if PLATFORM_UNIX
+    struct stat st;
+    if (stat(normalized.c_str(), &st) != 0) return normalized;
+
+    FileId id{static_cast<uint64_t>(st.st_dev), static_cast<uint64_t>(st.st_ino)};
+    return filePaths.insert(make_pair(id, normalized)).first->second;
+#else
+    error_code errorCode;
+    filesystem::path canonical = filesystem::canonical(path, errorCode);
+    return errorCode ? normalized : canonical.string();
+#endif
+}
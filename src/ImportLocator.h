@@ -0,0 +1,50 @@
+#pragma once
+
+#include <cstdint>
+#include <filesystem>
+#include <optional>
+#include <string>
+#include <unordered_map>
+#include <unordered_set>
+#include <vector>
+
+// finds files to import, remembering everything it looked up
+class ImportLocator {
+public:
+    // identifies a file regardless of the path it was reached through
+    struct FileId {
+        std::uint64_t dev, ino;
+
+        friend bool operator==(const FileId &l, const FileId &r)
+        { return l.dev == r.dev && l.ino == r.ino; }
+
+        friend bool operator!=(const FileId &l, const FileId &r)
+        { return !(l == r); }
+
+        struct Hasher {
+            std::size_t operator()(const FileId &id) const {
+                return std::hash<std::uint64_t>()(id.dev) ^ (std::hash<std::uint64_t>()(id.ino) << 1);
+            }
+        };
+    };
+
+private:
+    // the working directory is searched first, then the import paths, then the libs path
+    std::vector<std::filesystem::path> searchPaths;
+
+    std::unordered_map<std::string, std::optional<std::string>> located;
+    // names of entries of directories, listed when first needed, nullopt if the directory does not exist
+    std::unordered_map<std::string, std::optional<std::unordered_set<std::string>>> dirEntries;
+    std::unordered_map<FileId, std::string, FileId::Hasher> filePaths;
+
+    const std::optional<std::unordered_set<std::string>>& listDir(const std::filesystem::path &dir);
+    bool exists(const std::filesystem::path &path);
+
+public:
+    explicit ImportLocator(const std::vector<std::string> &importPaths);
+
+    // returns the path to the file, or nullopt if it was not found
+    std::optional<std::string> locate(const std::string &file);
+    // returns the same path for all paths leading to the same file
+    std::string identify(const std::filesystem::path &path);
+};
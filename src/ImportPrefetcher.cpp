@@ -0,0 +1,104 @@
+#include "ImportPrefetcher.h"
+#include <algorithm>
+using namespace std;
+
+ImportPrefetcher::ImportPrefetcher(NamePool *namePool, StringPool *stringPool, SourceManager *sourceManager, optional<unsigned> workerCnt)
+    : namePool(namePool), stringPool(stringPool), sourceManager(sourceManager) {
+    if (workerCnt.has_value()) {
+        this->workerCnt = workerCnt.value();
+        return;
+    }
+
+    // 0 if unknown
+    unsigned hardwareCnt = thread::hardware_concurrency();
+    this->workerCnt = hardwareCnt < 2 ? 0 : min(hardwareCnt-1, kMaxWorkerCnt);
+}
+
+ImportPrefetcher::~ImportPrefetcher() {
+    {
+        lock_guard<std::mutex> lock(mutex);
+        stopping = true;
+    }
+    cond.notify_all();
+
+    for (thread &worker : workers) worker.join();
+}
+
+ImportPrefetcher::LexedFile ImportPrefetcher::lex(const string &path, Interner *nameInterner, Interner *stringInterner) {
+    LexedFile lexed;
+
+    lexed.src = SourceManager::read(path);
+    if (lexed.src == nullptr) return lexed;
+
+    lexed.lexer.emplace(nameInterner, stringInterner, lexed.src.get());
+    lexed.tokens = lexed.lexer->tokenize();
+
+    return lexed;
+}
+
+void ImportPrefetcher::work() {
+    while (true) {
+        packaged_task<LexedFile()> task;
+        {
+            unique_lock<std::mutex> lock(mutex);
+            cond.wait(lock, [this] { return stopping || !queue.empty(); });
+            if (stopping) return;
+
+            task = move(queue.front().second);
+            queue.pop_front();
+        }
+
+        task();
+    }
+}
+
+void ImportPrefetcher::prefetch(const string &path) {
+    // workers would only compete with the loading thread
+    if (workerCnt == 0 || pending.find(path) != pending.end()) return;
+
+    packaged_task<LexedFile()> task([path, names = namePool->getInterner(), strings = stringPool->getInterner()] {
+        return lex(path, names, strings);
+    });
+    pending.insert(make_pair(path, task.get_future()));
+
+    {
+        lock_guard<std::mutex> lock(mutex);
+        queue.emplace_back(path, move(task));
+    }
+    cond.notify_one();
+
+    if (workers.empty()) {
+        for (unsigned i = 0; i < workerCnt; ++i) workers.emplace_back(&ImportPrefetcher::work, this);
+    }
+}
+
+ImportPrefetcher::LexedFile ImportPrefetcher::take(const string &path) {
+    auto loc = pending.find(path);
+    if (loc == pending.end()) return lex(path, namePool->getInterner(), stringPool->getInterner());
+
+    future<LexedFile> result = move(loc->second);
+    pending.erase(loc);
+
+    // not worth waiting for a worker to pick it up
+    {
+        lock_guard<std::mutex> lock(mutex);
+        auto it = find_if(queue.begin(), queue.end(), [&](const auto &queued) { return queued.first == path; });
+        if (it != queue.end()) {
+            queue.erase(it);
+            return lex(path, namePool->getInterner(), stringPool->getInterner());
+        }
+    }
+
+    return result.get();
+}
+
+const TokenBuffer* ImportPrefetcher::load(const string &path) {
+    StringPool::Id file = stringPool->add(path);
+
+    LexedFile lexed = take(path);
+    const SourceFile *src = sourceManager->add(file, move(lexed.src));
+    if (src == nullptr) return nullptr;
+
+    lexed.tokens->commit(file, src->getBase(), namePool->commit(lexed.lexer->getNames()), stringPool->commit(lexed.lexer->getStrings()));
+    return sourceManager->setTokens(file, move(lexed.tokens.value()));
+}
\ No newline at end of file
@@ -0,0 +1,68 @@
+#pragma once
+
+#include <condition_variable>
+#include <deque>
+#include <future>
+#include <memory>
+#include <mutex>
+#include <optional>
+#include <string>
+#include <thread>
+#include <unordered_map>
+#include <utility>
+#include <vector>
+#include "Interner.h"
+#include "Lexer.h"
+#include "NamePool.h"
+#include "SourceManager.h"
+#include "StringPool.h"
+#include "TokenBuffer.h"
+
+// reads and lexes files on worker threads, ahead of their imports being processed
+// files are added to the source manager and the pools only once loaded, so offsets and ids do not depend on timing
+class ImportPrefetcher {
+    // read and lexed apart from the source manager and the pools
+    struct LexedFile {
+        std::unique_ptr<SourceFile> src;
+        // holds the batches the tokens were lexed with
+        std::optional<Lexer> lexer;
+        std::optional<TokenBuffer> tokens;
+    };
+
+    static constexpr unsigned kMaxWorkerCnt = 4;
+
+    NamePool *namePool;
+    StringPool *stringPool;
+    SourceManager *sourceManager;
+
+    // none if disabled or there is no spare hardware thread
+    unsigned workerCnt;
+    // started along with the first prefetch
+    std::vector<std::thread> workers;
+    std::mutex mutex;
+    std::condition_variable cond;
+    bool stopping = false;
+    std::deque<std::pair<std::string, std::packaged_task<LexedFile()>>> queue;
+
+    // every prefetched file not yet loaded, only touched by the loading thread
+    std::unordered_map<std::string, std::future<LexedFile>> pending;
+
+    static LexedFile lex(const std::string &path, Interner *nameInterner, Interner *stringInterner);
+
+    void work();
+    LexedFile take(const std::string &path);
+
+public:
+    // if workerCnt is not given, uses the spare hardware threads
+    ImportPrefetcher(NamePool *namePool, StringPool *stringPool, SourceManager *sourceManager, std::optional<unsigned> workerCnt);
+    ~ImportPrefetcher();
+
+    ImportPrefetcher(const ImportPrefetcher&) = delete;
+    void operator=(const ImportPrefetcher&) = delete;
+
+    // starts lexing the file in the background, unless that was already done
+    void prefetch(const std::string &path);
+    // adds the file to the source manager along with its tokens, lexing it now if it had not been started yet
+    // returns nullptr if the file could not be read
+    const TokenBuffer* load(const std::string &path);
+};
\ No newline at end of file
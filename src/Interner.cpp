@@ -0,0 +1,81 @@
+#include "Interner.h"
+#include <functional>
+using namespace std;
+
+Interner::Table::Table(size_t cap) : mask(cap-1), slots(make_unique<atomic<const Entry*>[]>(cap)) {
+    for (size_t i = 0; i < cap; ++i) slots[i].store(nullptr, memory_order_relaxed);
+}
+
+Interner::Interner() {
+    for (Shard &shard : shards) {
+        shard.tables.push_back(make_unique<Table>(64));
+        shard.table.store(shard.tables.back().get(), memory_order_release);
+    }
+}
+
+const Interner::Entry* Interner::probe(const Table *table, size_t hash, string_view str) {
+    for (size_t i = slotOf(hash, table);; i = (i+1)&table->mask) {
+        // acquire, so that the entry is seen fully constructed
+        const Entry *entry = table->slots[i].load(memory_order_acquire);
+        if (entry == nullptr) return nullptr;
+        if (entry->hash == hash && entry->str == str) return entry;
+    }
+}
+
+void Interner::place(Table *table, const Entry *entry) {
+    size_t i = slotOf(entry->hash, table);
+    while (table->slots[i].load(memory_order_relaxed) != nullptr) i = (i+1)&table->mask;
+    table->slots[i].store(entry, memory_order_release);
+}
+
+void Interner::grow(Shard &shard) {
+    const Table *old = shard.table.load(memory_order_relaxed);
+
+    auto table = make_unique<Table>(2*(old->mask+1));
+    for (const Entry &entry : shard.entries) place(table.get(), &entry);
+
+    shard.table.store(table.get(), memory_order_release);
+    shard.tables.push_back(move(table));
+}
+
+const Interner::Entry* Interner::intern(string_view str) {
+    size_t hash = std::hash<string_view>()(str);
+    Shard &shard = shards[hash%kShardCnt];
+
+    const Entry *entry = probe(shard.table.load(memory_order_acquire), hash, str);
+    if (entry != nullptr) return entry;
+
+    lock_guard<mutex> lock(shard.mutex);
+
+    // may have been added since the lookup above
+    entry = probe(shard.table.load(memory_order_relaxed), hash, str);
+    if (entry != nullptr) return entry;
+
+    // kept at most half full, so probes stay short
+    if (2*(shard.entries.size()+1) > shard.table.load(memory_order_relaxed)->mask+1) grow(shard);
+
+    entry = &shard.entries.emplace_back(hash, str);
+    place(shard.table.load(memory_order_relaxed), entry);
+
+    return entry;
+}
+
+const Interner::Entry* Interner::find(string_view str) const {
+    size_t hash = std::hash<string_view>()(str);
+    const Shard &shard = shards[hash%kShardCnt];
+
+    return probe(shard.table.load(memory_order_acquire), hash, str);
+}
+
+uint32_t InternBatch::add(string_view str) {
+    const Interner::Entry *entry = interner->intern(str);
+
+    auto loc = localIds.find(entry);
+    if (loc != localIds.end()) return loc->second;
+
+    uint32_t id = static_cast<uint32_t>(entries.size());
+    localIds.insert(make_pair(entry, id));
+    entries.push_back(entry);
+
+    return id;
+}
\ No newline at end of file
@@ -0,0 +1,83 @@
+#pragma once
+
+#include <array>
+#include <atomic>
+#include <cstdint>
+#include <deque>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <string_view>
+#include <unordered_map>
+#include <vector>
+
+// stores each distinct string once, safe to use from several threads
+// strings are sharded by hash, finding an existing one takes no lock and adding a new one locks only its shard
+class Interner {
+public:
+    static constexpr std::uint32_t kNoId = UINT32_MAX;
+
+    // stays at the same address for the lifetime of the interner
+    struct Entry {
+        std::size_t hash;
+        std::string str;
+        // numbered by the owner of the interner, which must do so from a single thread
+        mutable std::atomic<std::uint32_t> id = kNoId;
+
+        Entry(std::size_t hash, std::string_view str) : hash(hash), str(str) {}
+    };
+
+private:
+    static constexpr std::size_t kShardCnt = 16;
+
+    // open addressing, slots are only ever filled, never cleared
+    struct Table {
+        std::size_t mask;
+        std::unique_ptr<std::atomic<const Entry*>[]> slots;
+
+        explicit Table(std::size_t cap);
+    };
+
+    struct Shard {
+        std::atomic<Table*> table = nullptr;
+
+        std::mutex mutex;
+        std::deque<Entry> entries;
+        // replaced tables are kept, as readers may still be probing them
+        std::vector<std::unique_ptr<Table>> tables;
+    };
+
+    std::array<Shard, kShardCnt> shards;
+
+    static std::size_t slotOf(std::size_t hash, const Table *table) { return (hash/kShardCnt)&table->mask; }
+    static const Entry* probe(const Table *table, std::size_t hash, std::string_view str);
+    static void place(Table *table, const Entry *entry);
+    void grow(Shard &shard);
+
+public:
+    Interner();
+
+    Interner(const Interner&) = delete;
+    void operator=(const Interner&) = delete;
+
+    const Entry* intern(std::string_view str);
+    // returns nullptr if the string was never interned
+    const Entry* find(std::string_view str) const;
+};
+
+// interns from any thread, numbering strings locally in the order they were first added
+// the owner of the interner later commits the batch to give them their real ids,
+// which come out the same as if the strings had been added to it directly in that order
+class InternBatch {
+    Interner *interner;
+    std::vector<const Interner::Entry*> entries;
+    std::unordered_map<const Interner::Entry*, std::uint32_t> localIds;
+
+public:
+    explicit InternBatch(Interner *interner) : interner(interner) {}
+
+    std::uint32_t add(std::string_view str);
+
+    // indexed by local id
+    const std::vector<const Interner::Entry*>& getEntries() const { return entries; }
+};
\ No newline at end of file
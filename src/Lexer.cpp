@@ -1,32 +1,35 @@
 #include "Lexer.h"
-#include <algorithm>
+#include <cerrno>
+#include <cmath>
 #include <cstdlib>
+#include <limits>
 #include <sstream>
+#include "charClasses.h"
 #include "unescape.h"
 using namespace std;
 
-static const string numLitChars = "0123456789abcdefABCDEF.xXpP_-";
-static const string idSpecialChars = "=+-*/%<>&|^!~[]._?";
-
-static bool isValidIdStart(char ch) {
-    return isalnum(ch) || idSpecialChars.find(ch) != idSpecialChars.npos;
-}
-
-Lexer::Lexer(NamePool *namePool, StringPool *stringPool, CompilationMessages *msgs, const std::string &filename)
-    : namePool(namePool), stringPool(stringPool), msgs(msgs), in(filename) {
+Lexer::Lexer(Interner *nameInterner, Interner *stringInterner, const SourceFile *src)
+    : names(nameInterner), strings(stringInterner), src(src) {
     ln = 0;
     col = 0;
     ch = 0; // not EOF
     tok.type = Token::T_NUM; // not END
-    fileId = stringPool->add(filename);
+    lineStart = src->getBase();
+    codeOffset = lineStart;
 }
 
-bool Lexer::start() {
-    if (!in.is_open()) return false;
+TokenBuffer Lexer::tokenize() {
+    TokenBuffer tokens(src->getFile());
 
     nextCh();
-    next();
-    return true;
+    do {
+        lexNext();
+        if (error.has_value()) tokens.addError(error.value(), codeOffset, lineStart+col);
+        else tokens.add(tok, codeOffset);
+    } while (tok.type != Token::T_END);
+
+    tokens.shrinkToFit();
+    return tokens;
 }
 
 char Lexer::nextCh() {
@@ -37,8 +40,7 @@ char Lexer::nextCh() {
     ++col;
 
     if (col > line.size()) {
-        if (!getline(in, line)) ch = EOF;
-        else ++ln;
+        if (!nextLine()) ch = EOF;
         col = 0;
     }
 
@@ -49,90 +51,138 @@ char Lexer::nextCh() {
     return old;
 }
 
+void Lexer::jumpTo(CodeIndex c) {
+    col = c;
+    ch = col == line.size() ? '\n' : line[col];
+}
+
+bool Lexer::nextLine() {
+    if (ln >= src->getLineCnt()) return false;
+
+    ++ln;
+    line = src->getLine(ln);
+    lineStart = src->getLineStart(ln);
+    return true;
+}
+
 void Lexer::skipLine() {
     if (over()) return;
 
-    if (!getline(in, line)) {
+    if (!nextLine()) {
         ch = EOF;
         return;
     }
 
-    ++ln;
     col = 0;
     ch = col == line.size() ? '\n' : line[col];
 }
 
+// parses digits in the given base, skipping '_' separators in place
+// fails on any other character and on values not fitting in int64_t
+static optional<int64_t> parseInt(string_view digits, int base) {
+    int64_t val = 0;
+    bool any = false;
+    for (char c : digits) {
+        if (c == '_') continue;
+
+        int digit;
+        if (c >= '0' && c <= '9') digit = c-'0';
+        else if (c >= 'a' && c <= 'f') digit = c-'a'+10;
+        else if (c >= 'A' && c <= 'F') digit = c-'A'+10;
+        else return nullopt;
+        if (digit >= base) return nullopt;
+
+        if (val > (numeric_limits<int64_t>::max()-digit)/base) return nullopt;
+        val = val*base+digit;
+        any = true;
+    }
+
+    // 0_, 0__... are allowed and equal to 0
+    if (!any && base != 8) return nullopt;
+    return val;
+}
+
+// strtod needs a terminated string, long literals are rare enough to allocate for
+static optional<double> parseFloat(string_view lit) {
+    char buff[128];
+    string longLit;
+    char *str = buff;
+    if (lit.size() >= sizeof(buff)) {
+        longLit.resize(lit.size());
+        str = longLit.data();
+    }
+
+    size_t len = 0;
+    for (char c : lit) {
+        if (c != '_') str[len++] = c;
+    }
+    str[len] = '\0';
+
+    char *end;
+    errno = 0;
+    double val = strtod(str, &end);
+    // underflow into a subnormal or zero also reports ERANGE, only overflow is an error
+    if (end != str+len || (errno == ERANGE && isinf(val))) return nullopt;
+    return val;
+}
+
 void Lexer::lexNum(CodeIndex from) {
     CodeIndex l = from;
-    while (numLitChars.find(peekCh()) != numLitChars.npos) nextCh();
+    jumpTo(scanCharClass(line, col, CC_NUM_LIT));
     CodeIndex r = col-1;
+    string_view lit = line.substr(l, r-l+1);
 
-    size_t dotIndex = line.find(".", l);
-    if (dotIndex != line.npos && dotIndex <= r) {
+    if (lit.find('.') != lit.npos) {
         tok.type = Token::T_FNUM;
 
-        string lit = line.substr(l, r-l+1);
-        if (lit.size() >= 3 && lit[0] == '0' && lit[1] == '_' && (lit[2] == 'x' || lit[2] == 'X')) {
-            tok.type = Token::T_UNKNOWN;
-        } else {
-            lit.erase(remove(lit.begin(), lit.end(), '_'), lit.end());
-
-            char *end;
-            tok.fnum = strtod(lit.c_str(), &end);
-            if (end != &*lit.end() || errno == ERANGE) tok.type = Token::T_UNKNOWN;
+        optional<double> val;
+        if (!(lit.size() >= 3 && lit[0] == '0' && lit[1] == '_' && (lit[2] == 'x' || lit[2] == 'X'))) {
+            val = parseFloat(lit);
         }
+
+        if (val.has_value()) tok.fnum = val.value();
+        else tok.type = Token::T_UNKNOWN;
     } else {
         tok.type = Token::T_NUM;
         int base = 10;
-        if (r-l+1 > 2 && line[l] == '0' && (line[l+1] == 'x' || line[l+1] == 'X')) {
+        if (lit.size() > 2 && lit[0] == '0' && (lit[1] == 'x' || lit[1] == 'X')) {
             base = 16;
-            l += 2;
-        } else if (r-l+1 > 2 && line[l] == '0' && line[l+1] == 'b') {
+            lit.remove_prefix(2);
+        } else if (lit.size() > 2 && lit[0] == '0' && lit[1] == 'b') {
             base = 2;
-            l += 2;
-        } else if (r-l+1 > 1 && line[l] == '0') {
+            lit.remove_prefix(2);
+        } else if (lit.size() > 1 && lit[0] == '0') {
             base = 8;
-            l += 1;
+            lit.remove_prefix(1);
         }
 
-        string lit = line.substr(l, r-l+1);
-        lit.erase(remove(lit.begin(), lit.end(), '_'), lit.end());
-        if (lit.empty()) {
-            // 0_, 0__... are allowed and equal to 0
-            if (base == 8) {
-                tok.num = 0;
-            } else {
-                tok.type = Token::T_UNKNOWN;
-            }
-        } else {
-            char *end;
-            tok.num = strtoll(lit.c_str(), &end, base);
-            if (end != &*lit.end() || errno == ERANGE) tok.type = Token::T_UNKNOWN;
-        }
+        optional<int64_t> val = parseInt(lit, base);
+        if (val.has_value()) tok.num = val.value();
+        else tok.type = Token::T_UNKNOWN;
     }
 
-    if (isValidIdStart(peekCh())) {
+    if (isCharClass(peekCh(), CC_ID)) {
         tok.type = Token::T_UNKNOWN;
     }
 }
 
 // TODO check tokens separated (eg. by whitespace)?
-Token Lexer::next() {
-    if (tok.type == Token::T_END) return tok;
-
-    Token old = tok;
+void Lexer::lexNext() {
+    error.reset();
 
     while (true) {
         char ch;
         do {
-            codeLocPoint.ln = ln;
-            codeLocPoint.col = col+1; // text editors are 1-indexed
+            // runs of whitespace within the line are skipped at once
+            if (!over()) jumpTo(scanCharClass(line, col, CC_SPACE));
+
+            codeOffset = lineStart+col;
             ch = nextCh();
-        } while (isspace(ch));
+        } while (isCharClass(ch, CC_SPACE));
 
         if (over()) {
             tok.type = Token::T_END;
-            return old;
+            return;
         }
 
         if (ch == '#') {
@@ -140,17 +190,17 @@ Token Lexer::next() {
                 nextCh();
                 do {
                     do {
+                        // skip to the next '$' within the line
+                        if (!over()) jumpTo(scanCharClass(line, col, CC_COMMENT_PLAIN));
+
                         ch = nextCh();
                     } while (ch != '$' && !over());
                 } while (peekCh() != '#' && !over());
 
                 if (over()) {
-                    CodeLocPoint codeLocPointEnd = codeLocPoint;
-                    codeLocPointEnd.col += 2;
-
                     tok.type = Token::T_UNKNOWN;
-                    msgs->errorUnclosedMultilineComment({fileId, codeLocPoint, codeLocPointEnd});
-                    return tok; // unclosed comment error, so skip old token
+                    error = TokenBuffer::LexError::kUnclosedMultilineComment;
+                    return;
                 }
 
                 nextCh(); // eat '#'
@@ -190,12 +240,9 @@ Token Lexer::next() {
             UnescapePayload unesc = unescape(line, col, true);
 
             if (unesc.status != UnescapePayload::Status::Success || unesc.unescaped.size() != 1) {
-                CodeLocPoint codeLocPointEnd = codeLocPoint;
-                codeLocPointEnd.col += 1;
-
                 tok.type = Token::T_UNKNOWN;
-                msgs->errorBadLiteral({fileId, codeLocPoint, codeLocPointEnd});
-                return tok; // unclosed char literal error, so skip old token
+                error = TokenBuffer::LexError::kBadLiteral;
+                return;
             } else {
                 tok.type = Token::T_CHAR;
                 tok.ch = unesc.unescaped[0];
@@ -235,27 +282,22 @@ Token Lexer::next() {
             }
 
             if (!success) {
-                CodeLocPoint codeLocPointEnd = codeLocPoint;
-                codeLocPointEnd.col += 1;
-
                 tok.type = Token::T_UNKNOWN;
-                msgs->errorBadLiteral({fileId, codeLocPoint, codeLocPointEnd});
-                return tok; // unclosed string literal error, so skip old token
+                error = TokenBuffer::LexError::kBadLiteral;
+                return;
             }
 
             tok.type = Token::T_STRING;
-            tok.stringId = stringPool->add(ss.str());
+            tok.stringId = StringPool::Id{strings.add(ss.str())};
         } else if (ch == '\\') {
             tok.type = Token::T_BACKSLASH;
         } else if (ch == ',') {
             tok.type = Token::T_COMMA;
-        } else if (isalnum(ch) || idSpecialChars.find(ch) != idSpecialChars.npos) {
-            int l = col-1;
-            while (isValidIdStart(peekCh())) {
-                ch = nextCh();
-            }
+        } else if (isCharClass(ch, CC_ID)) {
+            CodeIndex l = col-1;
+            jumpTo(scanCharClass(line, col, CC_ID));
 
-            string id = line.substr(l, col-l);
+            string_view id = line.substr(l, col-l);
 
             if (id == "true" || id == "false") {
                 tok.type = Token::T_BVAL;
@@ -264,21 +306,16 @@ Token Lexer::next() {
                 tok.type = Token::T_NULL;
             } else {
                 tok.type = Token::T_ID;
-                tok.nameId = namePool->add(id);
+                tok.nameId = NamePool::Id{names.add(id)};
             }
         } else {
             tok.type = Token::T_UNKNOWN;
         }
 
         if (tok.type == Token::T_UNKNOWN) {
-            msgs->errorBadToken({fileId, codeLocPoint, loc()});
+            error = TokenBuffer::LexError::kBadToken;
         }
 
-        return old;
+        return;
     }
-}
-
-// Eats the next token and returns whether it matches the type.
-bool Lexer::match(Token::Type type) {
-    return next().type == type;
 }
\ No newline at end of file
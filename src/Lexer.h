@@ -1,43 +1,48 @@
 #pragma once
 
-#include <fstream>
 #include <iostream>
+#include <optional>
 #include <string>
+#include <string_view>
 #include "CodeLoc.h"
-#include "CompilationMessages.h"
-#include "NamePool.h"
+#include "Interner.h"
+#include "SourceManager.h"
 #include "Token.h"
+#include "TokenBuffer.h"
 
+// works on a file of its own apart from the pools and the source manager, so files can be lexed on separate threads
 class Lexer {
-    NamePool *namePool;
-    StringPool *stringPool;
-    CompilationMessages *msgs;
-    std::ifstream in;
-    std::string line;
+    // ids in tokens are local to these until committed
+    InternBatch names, strings;
+    const SourceFile *src;
+    std::string_view line;
     CodeIndex ln, col;
+    // offset of the current line
+    CodeOffset lineStart;
     char ch;
     Token tok;
-    StringPool::Id fileId;
-    CodeLocPoint codeLocPoint;
+    std::optional<TokenBuffer::LexError> error;
+    CodeOffset codeOffset;
 
     bool over() const { return ch == EOF; }
 
     char peekCh() const { return ch; }
     char nextCh();
+    // moves within the current line
+    void jumpTo(CodeIndex c);
+    bool nextLine();
     void skipLine();
 
     void lexNum(CodeIndex from);
+    // lexes into tok, setting codeOffset to its start
+    void lexNext();
 
 public:
-    Lexer(NamePool *namePool, StringPool *stringPool, CompilationMessages *msgs, const std::string &filename);
+    Lexer(Interner *nameInterner, Interner *stringInterner, const SourceFile *src);
 
-    bool start();
+    // lexes the whole file, the tokens are to be committed along with the batches
+    TokenBuffer tokenize();
 
-    const Token& peek() const { return tok; }
-    Token next();
-    bool match(Token::Type type);
-
-    StringPool::Id file() const { return fileId; }
-    // Returns the location of the start of the token that would be returned by next().
-    CodeLocPoint loc() const { return codeLocPoint; }
+    const InternBatch& getNames() const { return names; }
+    const InternBatch& getStrings() const { return strings; }
 };
\ No newline at end of file
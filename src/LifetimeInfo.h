@@ -15,4 +15,6 @@ struct LifetimeInfo {
     bool noDrop = false;
     bool invokeArg = false;
     std::optional<NestLevel> nestLevel;
+
+    bool isDefault() const { return !noDrop && !invokeArg && !nestLevel.has_value(); }
 };
\ No newline at end of file
@@ -18,6 +18,7 @@ struct LiteralVal {
     };
 
     Kind kind = Kind::kNone;
+    EscapeScore escapeScore = 0;
     union {
         NamePool::Id val_id;
         std::int64_t val_si;
@@ -26,7 +27,6 @@ struct LiteralVal {
         bool val_b;
         StringPool::Id val_str;
     };
-    EscapeScore escapeScore = 0;
 
     bool isEscaped() const { return escapeScore > 0; }
 
@@ -1,2 +1,12 @@
 #include "LlvmVal.h"
 using namespace std;
+
+void LlvmVal::setVarId(optional<VarId> varId) {
+    if (!cold.isAllocated() && !varId.has_value()) return;
+    cold.get().varId = varId;
+}
+
+void LlvmVal::setLifetimeInfo(LifetimeInfo lifetimeInfo) {
+    if (!cold.isAllocated() && lifetimeInfo.isDefault()) return;
+    cold.get().lifetimeInfo = lifetimeInfo;
+}
\ No newline at end of file
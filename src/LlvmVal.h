@@ -1,15 +1,26 @@
 #pragma once
 
+#include "Boxed.h"
 #include "LifetimeInfo.h"
 #include "SymbolTableIds.h"
 #include "TypeTable.h"
 
 struct LlvmVal {
+private:
+    // only set on values of variables
+    struct Cold {
+        std::optional<VarId> varId;
+        LifetimeInfo lifetimeInfo;
+    };
+
+    Boxed<Cold> cold;
+
+public:
     TypeTable::Id type;
+    // set if ref may be less aligned than its type, as within packed data
+    llvm::MaybeAlign refAlign;
     llvm::Value *val = nullptr;
     llvm::Value *ref = nullptr;
-    std::optional<VarId> varId;
-    LifetimeInfo lifetimeInfo;
 
     LlvmVal() {}
     LlvmVal(TypeTable::Id ty) : type(ty) {}
@@ -17,5 +28,11 @@ struct LlvmVal {
     bool valBroken() const { return val == nullptr; }
     bool refBroken() const { return ref == nullptr; }
 
-    void removeRef() { ref = nullptr; varId.reset(); }
+    const std::optional<VarId>& getVarId() const { return cold.get().varId; }
+    void setVarId(std::optional<VarId> varId);
+
+    const LifetimeInfo& getLifetimeInfo() const { return cold.get().lifetimeInfo; }
+    void setLifetimeInfo(LifetimeInfo lifetimeInfo);
+
+    void removeRef() { ref = nullptr; refAlign = llvm::MaybeAlign(); setVarId(std::nullopt); }
 };
\ No newline at end of file
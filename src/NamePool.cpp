@@ -1,25 +1,29 @@
 #include "NamePool.h"
-#include <algorithm>
 #include <iostream>
 #include <vector>
 using namespace std;
 
-NamePool::NamePool() {
-    next.id = 0;
+NamePool::Id NamePool::idOf(const Interner::Entry *entry) {
+    uint32_t id = entry->id.load(memory_order_relaxed);
+    if (id == Interner::kNoId) {
+        id = static_cast<uint32_t>(entries.size());
+        entry->id.store(id, memory_order_relaxed);
+        entries.push_back(entry);
+    }
+
+    return Id{id};
 }
 
 NamePool::Id NamePool::add(const string &name) {
-    auto loc = ids.find(name);
-    if (loc != ids.end())
-        return loc->second;
-
-    ids[name] = next;
-    names[next] = name;
+    return idOf(interner.intern(name));
+}
 
-    Id ret = next;
-    next.id += 1;
+vector<NamePool::Id> NamePool::commit(const InternBatch &batch) {
+    vector<Id> ids;
+    ids.reserve(batch.getEntries().size());
+    for (const Interner::Entry *entry : batch.getEntries()) ids.push_back(idOf(entry));
 
-    return ret;
+    return ids;
 }
 
 NamePool::Id NamePool::addMain(const std::string &name) {
@@ -27,14 +31,13 @@ NamePool::Id NamePool::addMain(const std::string &name) {
     return main;
 }
 
-void NamePool::printAll() const {
-    vector<pair<Id::IdType, string>> collected;
-    for (const auto &it : names) {
-        collected.push_back({it.first.id, it.second});
-    }
-    sort(collected.begin(), collected.end());
+NamePool::Info& NamePool::getInfoForWrite(Id id) {
+    if (id.id >= infos.size()) infos.resize(id.id+1);
+    return infos[id.id];
+}
 
-    for (const auto &it : collected) {
-        cout << it.first << '\t' << it.second << endl;
+void NamePool::printAll() const {
+    for (size_t i = 0; i < entries.size(); ++i) {
+        cout << i << '\t' << entries[i]->str << endl;
     }
 }
\ No newline at end of file
@@ -1,8 +1,11 @@
 #pragma once
 
+#include <cstdint>
 #include <unordered_map>
 #include <unordered_set>
 #include <string>
+#include <vector>
+#include "Interner.h"
 
 class NamePool {
 public:
@@ -24,22 +27,43 @@ public:
         };
     };
 
+    // what a name stands for, so that classifying it takes a single load
+    // reserved names are kept as underlying values of the enums in reserved.h
+    struct Info {
+        static constexpr std::uint8_t kNone = 0xFF;
+
+        std::uint8_t meaningful = kNone;
+        std::uint8_t keyword = kNone;
+        std::uint8_t oper = kNone;
+        // names a type in TypeTable
+        bool type = false;
+    };
+
 private:
-    Id next;
+    Interner interner;
+    // indexed by id
+    std::vector<const Interner::Entry*> entries;
     Id main;
+    // indexed by id, names past the end have default info
+    std::vector<Info> infos;
 
-    std::unordered_map<Id, std::string, Id::Hasher> names;
-    std::unordered_map<std::string, Id> ids;
+    Id idOf(const Interner::Entry *entry);
 
 public:
-    NamePool();
-
     Id add(const std::string &name);
-    const std::string& get(Id id) const { return names.at(id); }
+    const std::string& get(Id id) const { return entries[id.id]->str; }
+
+    // names may be interned into a batch from other threads, while the ids are handed out only here
+    Interner* getInterner() { return &interner; }
+    // returns the ids of the batch names, indexed by their local ids
+    std::vector<Id> commit(const InternBatch &batch);
 
     Id addMain(const std::string &name);
     Id getMainId() const { return main; }
-    const std::string& getMain() const { return names.at(main); }
+    const std::string& getMain() const { return get(main); }
+
+    Info getInfo(Id id) const { return id.id < infos.size() ? infos[id.id] : Info(); }
+    Info& getInfoForWrite(Id id);
 
     // for debugging
     void printAll() const;
@@ -1,6 +1,14 @@
 #include "NodeVal.h"
+#include "AttrMap.h"
 using namespace std;
 
+struct NodeVal::Attrs {
+    optional<NodeVal> typeAttr, nonTypeAttrs;
+};
+
+// nodes are created for every token, keep them within a cache line
+static_assert(sizeof(NodeVal) <= 64);
+
 NodeVal::NodeVal() : value(false) {
 }
 
@@ -16,7 +24,7 @@ NodeVal::NodeVal(CodeLoc codeLoc, LiteralVal val) : codeLoc(codeLoc), value(val)
 NodeVal::NodeVal(CodeLoc codeLoc, SpecialVal val) : codeLoc(codeLoc), value(val) {
 }
 
-NodeVal::NodeVal(CodeLoc codeLoc, AttrMap val) : codeLoc(codeLoc), value(move(val)) {
+NodeVal::NodeVal(CodeLoc codeLoc, AttrMap val) : codeLoc(codeLoc), value(make_shared<AttrMap>(move(val))) {
 }
 
 NodeVal::NodeVal(CodeLoc codeLoc, EvalVal val) : codeLoc(codeLoc), value(move(val)) {
@@ -33,13 +41,12 @@ void NodeVal::copyFrom(const NodeVal &other) {
 
     value = other.value;
 
-    typeAttr.reset();
-    if (other.hasTypeAttr()) {
-        typeAttr = make_unique<NodeVal>(other.getTypeAttr());
-    }
-    nonTypeAttrs.reset();
-    if (other.hasNonTypeAttrs()) {
-        nonTypeAttrs = make_unique<NodeVal>(other.getNonTypeAttrs());
+    attrs = other.attrs;
+}
+
+void NodeVal::dropAttrsIfEmpty() {
+    if (attrs.isAllocated() && !attrs.get().typeAttr.has_value() && !attrs.get().nonTypeAttrs.has_value()) {
+        attrs.reset();
     }
 }
 
@@ -51,6 +58,22 @@ void NodeVal::operator=(const NodeVal &other) {
     if (this != &other) copyFrom(other);
 }
 
+NodeVal::NodeVal(NodeVal &&other) noexcept = default;
+
+NodeVal& NodeVal::operator=(NodeVal &&other) noexcept = default;
+
+NodeVal::~NodeVal() = default;
+
+AttrMap& NodeVal::getAttrMap() {
+    shared_ptr<AttrMap> &attrMap = get<shared_ptr<AttrMap>>(value);
+    if (attrMap.use_count() > 1) attrMap = make_shared<AttrMap>(*attrMap);
+    return *attrMap;
+}
+
+const AttrMap& NodeVal::getAttrMap() const {
+    return *get<shared_ptr<AttrMap>>(value);
+}
+
 bool NodeVal::isEscaped() const {
     return (isLiteralVal() && getLiteralVal().isEscaped()) ||
         (isEvalVal() && getEvalVal().isEscaped());
@@ -81,46 +104,42 @@ void NodeVal::removeRef() {
 
 optional<VarId> NodeVal::getVarId() const {
     if (isEvalVal()) return getEvalVal().getVarId();
-    else if (isLlvmVal()) return getLlvmVal().varId;
+    else if (isLlvmVal()) return getLlvmVal().getVarId();
     return nullopt;
 }
 
 bool NodeVal::isNoDrop() const {
     if (isEvalVal()) return getEvalVal().getLifetimeInfo().noDrop;
-    else if (isLlvmVal()) return getLlvmVal().lifetimeInfo.noDrop;
+    else if (isLlvmVal()) return getLlvmVal().getLifetimeInfo().noDrop;
     else return false;
 }
 
 bool NodeVal::isInvokeArg() const {
     if (isEvalVal()) return getEvalVal().getLifetimeInfo().invokeArg;
-    else if (isLlvmVal()) return getLlvmVal().lifetimeInfo.invokeArg;
+    else if (isLlvmVal()) return getLlvmVal().getLifetimeInfo().invokeArg;
     else return false;
 }
 
 bool NodeVal::setNoDrop(bool b) {
-    if (isEvalVal()) {
-        getEvalVal().getLifetimeInfo().noDrop = b;
-        return true;
-    } else if (isLlvmVal()) {
-        getLlvmVal().lifetimeInfo.noDrop = b;
-        return true;
-    } else {
-        return false;
-    }
+    optional<LifetimeInfo> lifetimeInfo = getLifetimeInfo();
+    if (!lifetimeInfo.has_value()) return false;
+
+    lifetimeInfo->noDrop = b;
+    return setLifetimeInfo(lifetimeInfo.value());
 }
 
 optional<LifetimeInfo> NodeVal::getLifetimeInfo() const {
     if (isEvalVal()) return getEvalVal().getLifetimeInfo();
-    else if (isLlvmVal()) return getLlvmVal().lifetimeInfo;
+    else if (isLlvmVal()) return getLlvmVal().getLifetimeInfo();
     else return nullopt;
 }
 
 bool NodeVal::setLifetimeInfo(LifetimeInfo lifetimeInfo) {
     if (isEvalVal()) {
-        getEvalVal().getLifetimeInfo() = lifetimeInfo;
+        getEvalVal().setLifetimeInfo(lifetimeInfo);
         return true;
     } else if (isLlvmVal()) {
-        getLlvmVal().lifetimeInfo = lifetimeInfo;
+        getLlvmVal().setLifetimeInfo(lifetimeInfo);
         return true;
     } else {
         return false;
@@ -134,16 +153,13 @@ void NodeVal::addChild(NodeVal &node, NodeVal c, TypeTable *typeTable) {
     node.getEvalVal().elems().push_back(move(c));
 }
 
-void NodeVal::addChildren(NodeVal &node, vector<NodeVal> c, TypeTable *typeTable) {
-    addChildren(node, c.begin(), c.end(), typeTable);
-}
-
-void NodeVal::addChildren(NodeVal &node, vector<NodeVal>::iterator start, vector<NodeVal>::iterator end, TypeTable *typeTable) {
+template<typename It>
+static void addChildrenMoved(NodeVal &node, It start, It end, TypeTable *typeTable) {
     node.getEvalVal().elems().reserve(node.getChildrenCnt()+(end-start));
 
     bool setCn = false;
     for (auto it = start; it != end; ++it) {
-        if (isRawVal(*it, typeTable) && typeTable->worksAsTypeCn(it->getEvalVal().getType())) setCn = true;
+        if (NodeVal::isRawVal(*it, typeTable) && typeTable->worksAsTypeCn(it->getEvalVal().getType())) setCn = true;
 
         node.getEvalVal().elems().push_back(move(*it));
     }
@@ -151,12 +167,66 @@ void NodeVal::addChildren(NodeVal &node, vector<NodeVal>::iterator start, vector
     if (setCn) node.getEvalVal().getType() = typeTable->addTypeCnOf(node.getEvalVal().getType());
 }
 
+void NodeVal::addChildren(NodeVal &node, pmr::vector<NodeVal> c, TypeTable *typeTable) {
+    addChildrenMoved(node, c.begin(), c.end(), typeTable);
+}
+
+void NodeVal::addChildren(NodeVal &node, vector<NodeVal>::iterator start, vector<NodeVal>::iterator end, TypeTable *typeTable) {
+    addChildrenMoved(node, start, end, typeTable);
+}
+
+bool NodeVal::hasTypeAttr() const {
+    return attrs.get().typeAttr.has_value();
+}
+
+NodeVal& NodeVal::getTypeAttr() {
+    return attrs.get().typeAttr.value();
+}
+
+const NodeVal& NodeVal::getTypeAttr() const {
+    return attrs.get().typeAttr.value();
+}
+
 void NodeVal::setTypeAttr(NodeVal t) {
-    typeAttr = make_unique<NodeVal>(move(t));
+    attrs.get().typeAttr = move(t);
+}
+
+void NodeVal::setTypeAttr(NodeVal t, pmr::memory_resource *arena) {
+    if (!attrs.isAllocated()) attrs = Boxed<Attrs>(Attrs(), arena);
+    attrs.get().typeAttr = move(t);
+}
+
+void NodeVal::clearTypeAttr() {
+    if (!attrs.isAllocated()) return;
+    attrs.get().typeAttr.reset();
+    dropAttrsIfEmpty();
+}
+
+bool NodeVal::hasNonTypeAttrs() const {
+    return attrs.get().nonTypeAttrs.has_value();
+}
+
+NodeVal& NodeVal::getNonTypeAttrs() {
+    return attrs.get().nonTypeAttrs.value();
+}
+
+const NodeVal& NodeVal::getNonTypeAttrs() const {
+    return attrs.get().nonTypeAttrs.value();
 }
 
 void NodeVal::setNonTypeAttrs(NodeVal a) {
-    nonTypeAttrs = make_unique<NodeVal>(move(a));
+    attrs.get().nonTypeAttrs = move(a);
+}
+
+void NodeVal::setNonTypeAttrs(NodeVal a, pmr::memory_resource *arena) {
+    if (!attrs.isAllocated()) attrs = Boxed<Attrs>(Attrs(), arena);
+    attrs.get().nonTypeAttrs = move(a);
+}
+
+void NodeVal::clearNonTypeAttrs() {
+    if (!attrs.isAllocated()) return;
+    attrs.get().nonTypeAttrs.reset();
+    dropAttrsIfEmpty();
 }
 
 bool NodeVal::isEmpty(const NodeVal &node, const TypeTable *typeTable) {
@@ -202,8 +272,8 @@ void NodeVal::escape(NodeVal &node, const TypeTable *typeTable, EscapeScore amou
             }
         }
     } else if (node.isAttrMap()) {
-        for (auto &it : node.getAttrMap().attrMap) {
-            escape(*it.second, typeTable, amount);
+        for (auto &it : node.getAttrMap()) {
+            escape(it.val, typeTable, amount);
         }
     }
 
@@ -224,8 +294,8 @@ void NodeVal::unescape(NodeVal &node, const TypeTable *typeTable, bool total) {
         if (total) node.getEvalVal().getEscapeScore() = 0;
         else node.getEvalVal().getEscapeScore() -= 1;
     } else if (node.isAttrMap()) {
-        for (auto &it : node.getAttrMap().attrMap) {
-            unescape(*it.second, typeTable, total);
+        for (auto &it : node.getAttrMap()) {
+            unescape(it.val, typeTable, total);
         }
     }
 
@@ -251,6 +321,10 @@ NodeVal NodeVal::makeEmpty(CodeLoc codeLoc, TypeTable *typeTable) {
     return NodeVal(codeLoc, emptyRaw);
 }
 
+NodeVal NodeVal::makeEmpty(CodeLoc codeLoc, TypeTable *typeTable, pmr::memory_resource *arena) {
+    return NodeVal(codeLoc, EvalVal::makeRawIn(arena, typeTable));
+}
+
 NodeVal NodeVal::copyNoRef(const NodeVal &k) {
     NodeVal nodeVal(k);
     nodeVal.removeRef();
@@ -1,10 +1,11 @@
 #pragma once
 
 #include <memory>
+#include <memory_resource>
 #include <unordered_map>
 #include <variant>
 #include <vector>
-#include "AttrMap.h"
+#include "Boxed.h"
 #include "CodeLoc.h"
 #include "EvalVal.h"
 #include "LifetimeInfo.h"
@@ -13,13 +14,20 @@
 #include "SpecialVal.h"
 #include "UndecidedCallableVal.h"
 
+class AttrMap;
+
 class NodeVal {
+    // most nodes have no attributes, so they are kept out of line
+    struct Attrs;
+
     CodeLoc codeLoc;
 
-    std::variant<bool, StringPool::Id, LiteralVal, SpecialVal, AttrMap, LlvmVal, EvalVal, UndecidedCallableVal> value;
-    std::unique_ptr<NodeVal> typeAttr, nonTypeAttrs;
+    // copies share the attribute map until one of them modifies it
+    std::variant<bool, StringPool::Id, LiteralVal, SpecialVal, std::shared_ptr<AttrMap>, LlvmVal, EvalVal, UndecidedCallableVal> value;
+    Boxed<Attrs> attrs;
 
     void copyFrom(const NodeVal &other);
+    void dropAttrsIfEmpty();
 
 public:
     // Invalid node
@@ -38,8 +46,10 @@ public:
     NodeVal(const NodeVal &other);
     void operator=(const NodeVal &other);
 
-    NodeVal(NodeVal &&other) = default;
-    NodeVal& operator=(NodeVal &&other) = default;
+    NodeVal(NodeVal &&other) noexcept;
+    NodeVal& operator=(NodeVal &&other) noexcept;
+
+    ~NodeVal();
 
     CodeLoc getCodeLoc() const { return codeLoc; }
     void setCodeLoc(CodeLoc loc) { codeLoc = loc; }
@@ -72,9 +82,9 @@ public:
     SpecialVal& getSpecialVal() { return std::get<SpecialVal>(value); }
     const SpecialVal& getSpecialVal() const { return std::get<SpecialVal>(value); }
 
-    bool isAttrMap() const { return std::holds_alternative<AttrMap>(value); }
-    AttrMap& getAttrMap() { return std::get<AttrMap>(value); }
-    const AttrMap& getAttrMap() const { return std::get<AttrMap>(value); }
+    bool isAttrMap() const { return std::holds_alternative<std::shared_ptr<AttrMap>>(value); }
+    AttrMap& getAttrMap();
+    const AttrMap& getAttrMap() const;
 
     bool isLlvmVal() const { return std::holds_alternative<LlvmVal>(value); }
     LlvmVal& getLlvmVal() { return std::get<LlvmVal>(value); }
@@ -87,24 +97,27 @@ public:
     NodeVal& getChild(std::size_t ind) { return getEvalVal().elems()[ind]; }
     const NodeVal& getChild(std::size_t ind) const { return getEvalVal().elems()[ind]; }
     static void addChild(NodeVal &node, NodeVal c, TypeTable *typeTable);
-    static void addChildren(NodeVal &node, std::vector<NodeVal> c, TypeTable *typeTable);
+    static void addChildren(NodeVal &node, std::pmr::vector<NodeVal> c, TypeTable *typeTable);
     static void addChildren(NodeVal &node, std::vector<NodeVal>::iterator start, std::vector<NodeVal>::iterator end, TypeTable *typeTable);
 
     bool isUndecidedCallableVal() const { return std::holds_alternative<UndecidedCallableVal>(value); }
     UndecidedCallableVal& getUndecidedCallableVal() { return std::get<UndecidedCallableVal>(value); }
     const UndecidedCallableVal& getUndecidedCallableVal() const { return std::get<UndecidedCallableVal>(value); }
 
-    bool hasTypeAttr() const { return typeAttr != nullptr; }
-    NodeVal& getTypeAttr() { return *typeAttr; }
-    const NodeVal& getTypeAttr() const { return *typeAttr; }
+    bool hasTypeAttr() const;
+    NodeVal& getTypeAttr();
+    const NodeVal& getTypeAttr() const;
     void setTypeAttr(NodeVal t);
-    void clearTypeAttr() { typeAttr.reset(); }
+    // if the node has no attributes yet, they are placed in the arena
+    void setTypeAttr(NodeVal t, std::pmr::memory_resource *arena);
+    void clearTypeAttr();
 
-    bool hasNonTypeAttrs() const { return nonTypeAttrs != nullptr; }
-    NodeVal& getNonTypeAttrs() { return *nonTypeAttrs; }
-    const NodeVal& getNonTypeAttrs() const { return *nonTypeAttrs; }
+    bool hasNonTypeAttrs() const;
+    NodeVal& getNonTypeAttrs();
+    const NodeVal& getNonTypeAttrs() const;
     void setNonTypeAttrs(NodeVal a);
-    void clearNonTypeAttrs() { nonTypeAttrs.reset(); }
+    void setNonTypeAttrs(NodeVal a, std::pmr::memory_resource *arena);
+    void clearNonTypeAttrs();
 
     static bool isEmpty(const NodeVal &node, const TypeTable *typeTable);
     static bool isLeaf(const NodeVal &node, const TypeTable *typeTable);
@@ -118,6 +131,8 @@ public:
     static void clearInvokeArg(NodeVal &node, const TypeTable *typeTable);
 
     static NodeVal makeEmpty(CodeLoc codeLoc, TypeTable *typeTable);
+    // its children are kept in the arena, so it must not outlive it
+    static NodeVal makeEmpty(CodeLoc codeLoc, TypeTable *typeTable, std::pmr::memory_resource *arena);
 
     // TODO remove as many calls to copyNoRef as possible
     static NodeVal copyNoRef(const NodeVal &k);
@@ -5,27 +5,51 @@
 using namespace std;
 
 Parser::Parser(StringPool *stringPool, TypeTable *typeTable, CompilationMessages *msgs) 
-    : stringPool(stringPool), typeTable(typeTable), lex(nullptr), msgs(msgs) {
+    : stringPool(stringPool), cursor(nullptr), typeTable(typeTable), msgs(msgs),
+    arenaBuff(make_unique<byte[]>(kArenaInitSize)), arena(arenaBuff.get(), kArenaInitSize) {
 }
 
-const Token& Parser::peek() const {
-    return lex->peek();
+void Parser::start(TokenCursor *cursor_) {
+    cursor = cursor_;
+    reportLexError();
+}
+
+// lexing errors are reported once the token becomes the next one
+// only the first, as the ones after it are usually caused by it
+void Parser::reportLexError() {
+    const TokenBuffer *tokens = cursor->tokens;
+    if (tokens->getType(cursor->ind) != Token::T_UNKNOWN || msgs->isFail()) return;
+
+    CodeOffset start = tokens->getStart(cursor->ind);
+    switch (tokens->getError(cursor->ind)) {
+    case TokenBuffer::LexError::kBadToken:
+        msgs->errorBadToken(tokens->getErrorCodeLoc(cursor->ind));
+        break;
+    case TokenBuffer::LexError::kBadLiteral:
+        msgs->errorBadLiteral(CodeLoc{start, 1});
+        break;
+    case TokenBuffer::LexError::kUnclosedMultilineComment:
+        msgs->errorUnclosedMultilineComment(CodeLoc{start, 2});
+        break;
+    }
 }
 
 pair<CodeLoc, Token> Parser::next() {
-    CodeLoc codeLoc;
-    codeLoc.file = lex->file();
-    codeLoc.start = lex->loc();
-    Token tok = lex->next();
-    codeLoc.end = lex->loc();
+    size_t ind = cursor->ind;
+
+    // T_END is returned over and over
+    if (ind+1 < cursor->tokens->size()) {
+        ++cursor->ind;
+        reportLexError();
+    }
 
-    return {codeLoc, tok};
+    return {cursor->tokens->getCodeLoc(ind), cursor->tokens->get(ind)};
 }
 
 // If the next token matches the type, eats it and returns true.
 // Otherwise, returns false.
 bool Parser::match(Token::Type type) {
-    if (peek().type != type) return false;
+    if (peekType() != type) return false;
     next();
     return true;
 }
@@ -46,7 +70,7 @@ bool Parser::matchCloseBraceOrError(Token openBrace) {
 
 EscapeScore Parser::parseEscapeScore() {
     EscapeScore escapeScore = 0;
-    while (peek().type == Token::T_BACKSLASH || peek().type == Token::T_COMMA) {
+    while (peekType() == Token::T_BACKSLASH || peekType() == Token::T_COMMA) {
         if (match(Token::T_BACKSLASH)) {
             ++escapeScore;
         } else {
@@ -58,14 +82,14 @@ EscapeScore Parser::parseEscapeScore() {
 }
 
 void Parser::parseTypeAttr(NodeVal &node) {
-    if (match(Token::T_COLON)) node.setTypeAttr(parseBare());
+    if (match(Token::T_COLON)) node.setTypeAttr(parseBare(), &arena);
 }
 
 void Parser::parseNonTypeAttrs(NodeVal &node) {
     if (match(Token::T_DOUBLE_COLON)) {
-        node.setNonTypeAttrs(parseBare());
+        node.setNonTypeAttrs(parseBare(), &arena);
     } else {
-        if (peek().type == Token::T_COLON) {
+        if (peekType() == Token::T_COLON) {
             pair<CodeLoc, Token> colon = next();
 
             msgs->errorUnexpectedTokenType(colon.first, colon.second);
@@ -78,7 +102,7 @@ NodeVal Parser::parseBare() {
     EscapeScore escapeScore = parseEscapeScore();
 
     NodeVal nodeVal;
-    if (peek().type == Token::T_BRACE_L_REG || peek().type == Token::T_BRACE_L_CUR)
+    if (peekType() == Token::T_BRACE_L_REG || peekType() == Token::T_BRACE_L_CUR)
         nodeVal = parseNode(true);
     else
         nodeVal = parseTerm(true);
@@ -135,39 +159,34 @@ NodeVal Parser::parseTerm(bool ignoreAttrs) {
 }
 
 NodeVal Parser::parseNode(bool ignoreAttrs) {
-    CodeLoc codeLoc;
-    codeLoc.file = lex->file();
-    codeLoc.start = lex->loc();
+    CodeOffset start = loc();
 
-    NodeVal node = NodeVal::makeEmpty(CodeLoc(), typeTable);
+    NodeVal node = NodeVal::makeEmpty(CodeLoc(), typeTable, &arena);
 
     EscapeScore escapeScore = parseEscapeScore();
 
-    if (peek().type == Token::T_BRACE_L_REG || peek().type == Token::T_BRACE_L_CUR) {
+    if (peekType() == Token::T_BRACE_L_REG || peekType() == Token::T_BRACE_L_CUR) {
         pair<CodeLoc, Token> openBrace = next();
 
-        vector<NodeVal> children;
+        pmr::vector<NodeVal> children(&arena);
 
-        while (peek().type != Token::T_BRACE_R_REG && peek().type != Token::T_BRACE_R_CUR) {
-            if (peek().type == Token::T_SEMICOLON) {
+        while (peekType() != Token::T_BRACE_R_REG && peekType() != Token::T_BRACE_R_CUR) {
+            if (peekType() == Token::T_SEMICOLON) {
                 pair<CodeLoc, Token> semicolon = next();
 
                 if (children.empty()) {
-                    NodeVal::addChild(node, NodeVal::makeEmpty(semicolon.first, typeTable), typeTable);
+                    NodeVal::addChild(node, NodeVal::makeEmpty(semicolon.first, typeTable, &arena), typeTable);
                 } else {
-                    CodeLoc codeLoc;
-                    codeLoc.file = lex->file();
-                    codeLoc.start = children.front().getCodeLoc().start;
-                    codeLoc.end = semicolon.first.end;
+                    CodeLoc codeLoc = CodeLoc::make(children.front().getCodeLoc().start, semicolon.first.end());
 
-                    NodeVal tuple = NodeVal::makeEmpty(codeLoc, typeTable);
+                    NodeVal tuple = NodeVal::makeEmpty(codeLoc, typeTable, &arena);
                     NodeVal::addChildren(tuple, move(children), typeTable); // children is emptied here
                     NodeVal::addChild(node, move(tuple), typeTable);
                 }
             } else {
                 EscapeScore escapeScore = parseEscapeScore();
                 NodeVal child;
-                if (peek().type == Token::T_BRACE_L_REG || peek().type == Token::T_BRACE_L_CUR) {
+                if (peekType() == Token::T_BRACE_L_REG || peekType() == Token::T_BRACE_L_CUR) {
                     child = parseNode();
                 } else {
                     child = parseTerm();
@@ -180,15 +199,14 @@ NodeVal Parser::parseNode(bool ignoreAttrs) {
 
         if (!matchCloseBraceOrError(openBrace.second)) return NodeVal();
 
-        codeLoc.end = lex->loc(); // code loc point after close brace
-        node.setCodeLoc(codeLoc);
+        node.setCodeLoc(CodeLoc::make(start, loc())); // code loc point after close brace
 
         NodeVal::addChildren(node, move(children), typeTable);
     } else {
-        while (peek().type != Token::T_SEMICOLON) {
+        while (peekType() != Token::T_SEMICOLON) {
             escapeScore += parseEscapeScore();
             NodeVal child;
-            if (peek().type == Token::T_BRACE_L_REG || peek().type == Token::T_BRACE_L_CUR) {
+            if (peekType() == Token::T_BRACE_L_REG || peekType() == Token::T_BRACE_L_CUR) {
                 child = parseNode();
             } else {
                 child = parseTerm();
@@ -201,8 +219,7 @@ NodeVal Parser::parseNode(bool ignoreAttrs) {
 
         next();
 
-        codeLoc.end = lex->loc(); // code loc point after semicolon
-        node.setCodeLoc(codeLoc);
+        node.setCodeLoc(CodeLoc::make(start, loc())); // code loc point after semicolon
     }
 
     if (!ignoreAttrs) {
@@ -213,4 +230,10 @@ NodeVal Parser::parseNode(bool ignoreAttrs) {
     NodeVal::escape(node, typeTable, escapeScore);
 
     return node;
+}
+
+NodeVal Parser::parseTopmost() {
+    arena.release();
+
+    return parseNode();
 }
\ No newline at end of file
@@ -1,18 +1,29 @@
 #pragma once
 
+#include <cstddef>
+#include <memory>
+#include <memory_resource>
 #include "CompilationMessages.h"
-#include "Lexer.h"
 #include "NodeVal.h"
+#include "TokenBuffer.h"
 #include "TypeTable.h"
 
 class Parser {
     StringPool *stringPool;
-    Lexer *lex;
+    TokenCursor *cursor;
     TypeTable *typeTable;
     CompilationMessages *msgs;
 
-    const Token& peek() const;
+    static constexpr std::size_t kArenaInitSize = 64*1024;
+    // holds the nodes of the current top-level node, most forms fit in the initial buffer
+    std::unique_ptr<std::byte[]> arenaBuff;
+    std::pmr::monotonic_buffer_resource arena;
+
+    Token::Type peekType() const { return cursor->tokens->getType(cursor->ind); }
     std::pair<CodeLoc, Token> next();
+    // start of the token that would be returned by next()
+    CodeOffset loc() const { return cursor->tokens->getStart(cursor->ind); }
+    void reportLexError();
 
     bool match(Token::Type type);
     bool matchCloseBraceOrError(Token openBrace);
@@ -23,14 +34,20 @@ class Parser {
 
     NodeVal parseBare();
     NodeVal parseTerm(bool ignoreAttrs = false);
+    NodeVal parseNode(bool ignoreAttrs = false);
 
 public:
     Parser(StringPool *stringPool, TypeTable *typeTable, CompilationMessages *msgs);
 
-    void setLexer(Lexer *lex_) { lex = lex_; }
-    Lexer* getLexer() const { return lex; }
+    // starts parsing tokens from the cursor's position
+    void start(TokenCursor *cursor_);
+    // continues parsing where the cursor was left off
+    void setCursor(TokenCursor *cursor_) { cursor = cursor_; }
+    TokenCursor* getCursor() const { return cursor; }
 
-    NodeVal parseNode(bool ignoreAttrs = false);
+    // the returned node is kept in an arena reused by the next call, so it must not be used after that
+    // copies of it, or of any of its parts, are not kept in the arena
+    NodeVal parseTopmost();
 
-    bool isOver() const { return peek().type == Token::T_END; }
+    bool isOver() const { return peekType() == Token::T_END; }
 };
\ No newline at end of file
@@ -58,10 +58,7 @@ NodeVal Processor::processNonLeaf(const NodeVal &node, bool topmost) {
     if (starting.isInvalid()) return NodeVal();
 
     if (NodeVal::isMacro(starting, typeTable)) {
-        NodeVal invoked = processInvoke(node, starting);
-        if (invoked.isInvalid()) return NodeVal();
-
-        return processNode(invoked);
+        return processInvoke(node, starting);
     }
 
     if (starting.isEvalVal() && EvalVal::isId(starting.getEvalVal(), typeTable)) {
@@ -77,7 +74,7 @@ NodeVal Processor::processNonLeaf(const NodeVal &node, bool topmost) {
     }
 
     if (starting.isSpecialVal()) {
-        optional<Keyword> keyw = getKeyword(starting.getSpecialVal().id);
+        optional<Keyword> keyw = getKeyword(starting.getSpecialVal().id, namePool);
         if (keyw.has_value()) {
             switch (keyw.value()) {
             case Keyword::SYM:
@@ -128,7 +125,7 @@ NodeVal Processor::processNonLeaf(const NodeVal &node, bool topmost) {
             }
         }
 
-        optional<Oper> op = getOper(starting.getSpecialVal().id);
+        optional<Oper> op = getOper(starting.getSpecialVal().id, namePool);
         if (op.has_value()) {
             return processOper(node, starting, op.value());
         }
@@ -214,7 +211,7 @@ NodeVal Processor::processId(const NodeVal &node) {
         if (varEntry.var.isUndecidedCallableVal()) return loadUndecidedCallable(node, varEntry.var);
 
         return dispatchLoad(node.getCodeLoc(), varIdOpt.value(), id);
-    } else if (isKeyword(id) || isOper(id)) {
+    } else if (isKeyword(id, namePool) || isOper(id, namePool)) {
         SpecialVal spec;
         spec.id = id;
 
@@ -683,13 +680,33 @@ NodeVal Processor::processData(const NodeVal &node, const NodeVal &starting) {
             dataType.elements.push_back(elemEntry);
         }
 
+        optional<bool> attrPacked = getAttributeForBool(nodeElems, "packed");
+        if (!attrPacked.has_value()) return NodeVal();
+        dataType.packed = attrPacked.value();
+
+        optional<NodeVal> attrAlign = getAttribute(nodeElems, "align");
+        if (attrAlign.has_value()) {
+            if (!checkIsEvalVal(attrAlign.value(), true)) return NodeVal();
+
+            optional<uint64_t> alignment = EvalVal::getValueNonNeg(attrAlign.value().getEvalVal(), typeTable);
+            if (!alignment.has_value() || !isPowOf2(alignment.value()) || alignment.value() > TypeTable::DataType::kMaxAlignment) {
+                msgs->errorDataBadAlignment(attrAlign.value().getCodeLoc());
+                return NodeVal();
+            }
+            if (dataType.packed) {
+                msgs->errorDataPackedAligned(attrAlign.value().getCodeLoc());
+                return NodeVal();
+            }
+            dataType.alignment = alignment.value();
+        }
+
         typeIdOpt = typeTable->addDataType(dataType);
         if (!typeIdOpt.has_value()) {
             msgs->errorInternal(node.getCodeLoc());
             return NodeVal();
         }
 
-        if (nodeElems.hasNonTypeAttrs() && !nodeElems.getNonTypeAttrs().getAttrMap().attrMap.empty()) {
+        if (nodeElems.hasNonTypeAttrs() && !nodeElems.getNonTypeAttrs().getAttrMap().empty()) {
             symbolTable->registerDataAttrs(typeIdOpt.value(), move(nodeElems.getNonTypeAttrs().getAttrMap()));
         }
 
@@ -870,8 +887,12 @@ NodeVal Processor::processInvoke(const NodeVal &node, const NodeVal &starting) {
     }
     argTmpRaii.clear(); // no longer possible to break out of arg processing
 
-    NodeVal ret = invoke(node.getCodeLoc(), macroId.value(), move(args));
-    if (ret.isInvalid()) return NodeVal();
+    NodeVal invoked = invoke(node.getCodeLoc(), macroId.value(), move(args));
+    if (invoked.isInvalid()) return NodeVal();
+
+    if (!performExpansionSetUp(node.getCodeLoc(), macroId.value())) return NodeVal();
+    NodeVal ret = processNode(invoked);
+    if (!performExpansionTearDown(node.getCodeLoc())) return NodeVal();
 
     return ret;
 }
@@ -908,6 +929,8 @@ NodeVal Processor::processFnc(const NodeVal &node, const NodeVal &starting) {
     bool noNameMangle;
     bool isMain;
     bool evaluable, compilable;
+    FastMathAttrs fastMath;
+    FuncValue::OptAttrs optAttrs;
     {
         NodeVal nodeName = processForIdValue(node.getChild(indName));
         if (nodeName.isInvalid()) return NodeVal();
@@ -921,7 +944,7 @@ NodeVal Processor::processFnc(const NodeVal &node, const NodeVal &starting) {
 
         optional<bool> attrNoNameMangle = getAttributeForBool(nodeName, "noNameMangle");
         if (!attrNoNameMangle.has_value()) return NodeVal();
-        isMain = isMeaningful(name, Meaningful::MAIN);
+        isMain = isMeaningful(name, Meaningful::MAIN, namePool);
         noNameMangle = attrNoNameMangle.value();
 
         optional<bool> attrEvaluableOpt = getAttributeForBool(nodeName, "evaluable", this == evaluator);
@@ -932,6 +955,14 @@ NodeVal Processor::processFnc(const NodeVal &node, const NodeVal &starting) {
         if (!attrCompilableOpt.has_value()) return NodeVal();
         compilable = attrCompilableOpt.value();
 
+        optional<FastMathAttrs> attrFastMath = getAttributesForFastMath(nodeName, false);
+        if (!attrFastMath.has_value()) return NodeVal();
+        fastMath = attrFastMath.value();
+
+        optional<FuncValue::OptAttrs> attrOptAttrs = getAttributesForFuncOpt(nodeName);
+        if (!attrOptAttrs.has_value()) return NodeVal();
+        optAttrs = attrOptAttrs.value();
+
         if (!evaluable && !compilable) {
             CodeLoc codeLoc = (nodeName.hasNonTypeAttrs() ? nodeName.getNonTypeAttrs() : nodeName).getCodeLoc();
             msgs->errorFuncNotEvalOrCompiled(codeLoc);
@@ -942,13 +973,14 @@ NodeVal Processor::processFnc(const NodeVal &node, const NodeVal &starting) {
     // arguments
     vector<NamePool::Id> argNames;
     vector<TypeTable::Id> argTypes;
-    vector<bool> argNoDrops;
+    vector<bool> argNoDrops, argNoAliases;
     const NodeVal &nodeArgs = processWithEscape(node.getChild(indArgs));
     if (nodeArgs.isInvalid()) return NodeVal();
     if (!checkIsRaw(nodeArgs, true)) return NodeVal();
     argNames.reserve(nodeArgs.getChildrenCnt());
     argTypes.reserve(nodeArgs.getChildrenCnt());
     argNoDrops.reserve(nodeArgs.getChildrenCnt());
+    argNoAliases.reserve(nodeArgs.getChildrenCnt());
     optional<bool> variadic = getAttributeForBool(nodeArgs, "variadic");
     if (!variadic.has_value()) return NodeVal();
     for (size_t i = 0; i < nodeArgs.getChildrenCnt(); ++i) {
@@ -970,9 +1002,17 @@ NodeVal Processor::processFnc(const NodeVal &node, const NodeVal &starting) {
         optional<bool> attrNoDrop = getAttributeForBool(arg.first, "noDrop");
         if (!attrNoDrop.has_value()) return NodeVal();
 
+        optional<bool> attrNoAlias = getAttributeForBool(arg.first, "noAlias");
+        if (!attrNoAlias.has_value()) return NodeVal();
+        if (attrNoAlias.value() && !typeTable->worksAsTypeAnyP(argTy)) {
+            msgs->errorArgNoAliasNonPointer(nodeArg.getCodeLoc());
+            return NodeVal();
+        }
+
         argNames.push_back(argId);
         argTypes.push_back(argTy);
         argNoDrops.push_back(attrNoDrop.value());
+        argNoAliases.push_back(attrNoAlias.value());
     }
 
     // check no arg name duplicates
@@ -1014,6 +1054,7 @@ NodeVal Processor::processFnc(const NodeVal &node, const NodeVal &starting) {
         callable.setArgCnt(argTypes.size());
         callable.setArgTypes(argTypes);
         callable.setArgNoDrops(argNoDrops);
+        callable.setArgNoAliases(argNoAliases);
         callable.retType = retType;
         callable.variadic = variadic.value();
         type = typeTable->addCallable(callable);
@@ -1026,6 +1067,8 @@ NodeVal Processor::processFnc(const NodeVal &node, const NodeVal &starting) {
     funcVal.argNames = argNames;
     funcVal.noNameMangle = noNameMangle || isMain || variadic.value();
     funcVal.defined = isDef;
+    funcVal.fastMath = fastMath;
+    funcVal.optAttrs = optAttrs;
 
     // register only if first func of its name
     if (!symbolTable->isFuncName(name)) {
@@ -1446,7 +1489,7 @@ NodeVal Processor::processOper(const NodeVal &node, const NodeVal &starting, Ope
     }
 
     if (operInfo.comparison) {
-        return processOperComparison(starting.getCodeLoc(), operands, op);
+        return processOperComparison(starting.getCodeLoc(), starting, operands, op);
     } else if (op == Oper::ASGN) {
         return processOperAssignment(starting.getCodeLoc(), operands);
     } else if (op == Oper::IND) {
@@ -1593,10 +1636,10 @@ NodeVal Processor::processAttrIsDef(const NodeVal &node) {
 // not able to fail, only to not find
 // update callers if that changes
 optional<NodeVal> Processor::getAttribute(const AttrMap &attrs, NamePool::Id attrName) {
-    auto loc = attrs.attrMap.find(attrName);
-    if (loc == attrs.attrMap.end()) return nullopt;
+    const NodeVal *attr = attrs.find(attrName);
+    if (attr == nullptr) return nullopt;
 
-    return *loc->second;
+    return *attr;
 }
 
 optional<NodeVal> Processor::getAttribute(const NodeVal &node, NamePool::Id attrName) {
@@ -1646,6 +1689,93 @@ optional<NodeVal> Processor::getAttributeFull(const NodeVal &node, NamePool::Id
     return nullopt;
 }
 
+optional<FastMathAttrs> Processor::getAttributesForFastMath(const NodeVal &node, bool withCallee) {
+    FastMathAttrs fastMath;
+
+    optional<bool> attrFast = getAttributeForBool(node, "fast");
+    if (!attrFast.has_value()) return nullopt;
+    fastMath.fast = attrFast.value();
+
+    optional<bool> attrReassoc = getAttributeForBool(node, "reassoc");
+    if (!attrReassoc.has_value()) return nullopt;
+    fastMath.reassoc = attrReassoc.value();
+
+    optional<bool> attrContract = getAttributeForBool(node, "contract");
+    if (!attrContract.has_value()) return nullopt;
+    fastMath.contract = attrContract.value();
+
+    optional<bool> attrNnan = getAttributeForBool(node, "nnan");
+    if (!attrNnan.has_value()) return nullopt;
+    fastMath.nnan = attrNnan.value();
+
+    optional<bool> attrNinf = getAttributeForBool(node, "ninf");
+    if (!attrNinf.has_value()) return nullopt;
+    fastMath.ninf = attrNinf.value();
+
+    optional<bool> attrArcp = getAttributeForBool(node, "arcp");
+    if (!attrArcp.has_value()) return nullopt;
+    fastMath.arcp = attrArcp.value();
+
+    if (withCallee) {
+        optional<SymbolTable::CalleeValueInfo> callee = symbolTable->getCurrCallee();
+        if (callee.has_value()) fastMath.merge(callee.value().fastMath);
+    }
+
+    return fastMath;
+}
+
+optional<FuncValue::OptAttrs> Processor::getAttributesForFuncOpt(const NodeVal &node) {
+    FuncValue::OptAttrs optAttrs;
+
+    optional<bool> attrInline = getAttributeForBool(node, "inline");
+    if (!attrInline.has_value()) return nullopt;
+    optAttrs.alwaysInline = attrInline.value();
+
+    optional<bool> attrNoInline = getAttributeForBool(node, "noInline");
+    if (!attrNoInline.has_value()) return nullopt;
+    optAttrs.noInline = attrNoInline.value();
+
+    optional<bool> attrHot = getAttributeForBool(node, "hot");
+    if (!attrHot.has_value()) return nullopt;
+    optAttrs.hot = attrHot.value();
+
+    optional<bool> attrCold = getAttributeForBool(node, "cold");
+    if (!attrCold.has_value()) return nullopt;
+    optAttrs.cold = attrCold.value();
+
+    optional<bool> attrReadNone = getAttributeForBool(node, "readNone");
+    if (!attrReadNone.has_value()) return nullopt;
+    optAttrs.readNone = attrReadNone.value();
+
+    optional<bool> attrReadOnly = getAttributeForBool(node, "readOnly");
+    if (!attrReadOnly.has_value()) return nullopt;
+    optAttrs.readOnly = attrReadOnly.value();
+
+    optional<bool> attrNoReturn = getAttributeForBool(node, "noReturn");
+    if (!attrNoReturn.has_value()) return nullopt;
+    optAttrs.noReturn = attrNoReturn.value();
+
+    optional<bool> attrMinSize = getAttributeForBool(node, "minSize");
+    if (!attrMinSize.has_value()) return nullopt;
+    optAttrs.minSize = attrMinSize.value();
+
+    CodeLoc codeLoc = (node.hasNonTypeAttrs() ? node.getNonTypeAttrs() : node).getCodeLoc();
+    if (optAttrs.alwaysInline && optAttrs.noInline) {
+        msgs->errorFuncConflictingAttrs(codeLoc, "inline", "noInline");
+        return nullopt;
+    }
+    if (optAttrs.hot && optAttrs.cold) {
+        msgs->errorFuncConflictingAttrs(codeLoc, "hot", "cold");
+        return nullopt;
+    }
+    if (optAttrs.readNone && optAttrs.readOnly) {
+        msgs->errorFuncConflictingAttrs(codeLoc, "readNone", "readOnly");
+        return nullopt;
+    }
+
+    return optAttrs;
+}
+
 NodeVal Processor::promoteBool(CodeLoc codeLoc, bool b) const {
     EvalVal evalVal = EvalVal::makeVal(typeTable->getPrimTypeId(TypeTable::P_BOOL), typeTable);
     evalVal.b() = b;
@@ -1729,7 +1859,7 @@ bool Processor::canBeTypeDescrDecor(const NodeVal &node) {
     if (!node.isEvalVal()) return false;
 
     if (EvalVal::isId(node.getEvalVal(), typeTable)) {
-        return isTypeDescrDecor(node.getEvalVal().id());
+        return isTypeDescrDecor(node.getEvalVal().id(), namePool);
     }
 
     return EvalVal::isI(node.getEvalVal(), typeTable) || EvalVal::isU(node.getEvalVal(), typeTable);
@@ -1742,7 +1872,7 @@ bool Processor::applyTypeDescrDecor(TypeTable::TypeDescr &descr, const NodeVal &
     }
 
     if (EvalVal::isId(node.getEvalVal(), typeTable)) {
-        optional<Meaningful> mean = getMeaningful(node.getEvalVal().id());
+        optional<Meaningful> mean = getMeaningful(node.getEvalVal().id(), namePool);
         if (!mean.has_value() || !isTypeDescrDecor(mean.value())) {
             msgs->errorInvalidTypeDecorator(node.getCodeLoc());
             return false;
@@ -2123,6 +2253,9 @@ NodeVal Processor::moveNode(CodeLoc codeLoc, NodeVal val, bool noZero) {
         if (zero.isInvalid()) return NodeVal();
 
         if (dispatchAssignment(codeLoc, val, move(zero)).isInvalid()) return NodeVal();
+
+        optional<VarId> varId = val.getVarId();
+        if (varId.has_value() && !performMovedFrom(codeLoc, varId.value())) return NodeVal();
     }
 
     // val itself remained unchanged
@@ -2261,8 +2394,12 @@ bool Processor::callDropFuncs(CodeLoc codeLoc, vector<variant<VarId, NodeVal>> v
             SymbolTable::VarEntry &varEntry = symbolTable->getVar(varId);
             if (varEntry.skipDrop || varEntry.var.isNoDrop()) continue;
 
+            DropGuardSignal dropGuard = performDropGuardSetUp(codeLoc, varId);
+
             NodeVal loaded = dispatchLoad(codeLoc, varId);
             if (!callDropFunc(codeLoc, move(loaded))) return false;
+
+            if (!performDropGuardTearDown(codeLoc, dropGuard)) return false;
         } else {
             if (!callDropFunc(codeLoc, move(get<NodeVal>(it)))) return false;
         }
@@ -2314,8 +2451,8 @@ bool Processor::processAttributes(NodeVal &node, bool forceUnescape) {
         if (node.getNonTypeAttrs().isAttrMap()) {
             AttrMap &attrMap = node.getNonTypeAttrs().getAttrMap();
 
-            for (auto &it : attrMap.attrMap) {
-                NodeVal &attrVal = *it.second;
+            for (auto &it : attrMap) {
+                NodeVal &attrVal = it.val;
 
                 if (forceUnescape) NodeVal::unescape(attrVal, typeTable, true);
 
@@ -2323,7 +2460,7 @@ bool Processor::processAttributes(NodeVal &node, bool forceUnescape) {
                 if (attrVal.isInvalid()) return false;
                 if (!checkIsEvalVal(attrVal, true)) return false;
                 if (!hasTrivialDrop(attrVal.getType().value())) {
-                    msgs->errorAttributeOwning(attrVal.getCodeLoc(), it.first);
+                    msgs->errorAttributeOwning(attrVal.getCodeLoc(), it.name);
                     return false;
                 }
             }
@@ -2344,7 +2481,7 @@ bool Processor::processAttributes(NodeVal &node, bool forceUnescape) {
 
                 NodeVal attrVal = promoteBool(nodeAttrs.getCodeLoc(), true);
 
-                attrMap.attrMap.insert({attrName, make_unique<NodeVal>(move(attrVal))});
+                attrMap.insert(attrName, move(attrVal));
             } else {
                 for (size_t i = 0; i < nodeAttrs.getChildrenCnt(); ++i) {
                     NodeVal &nodeAttrEntry = nodeAttrs.getChild(i);
@@ -2366,7 +2503,7 @@ bool Processor::processAttributes(NodeVal &node, bool forceUnescape) {
                         msgs->errorNonTypeAttributeType(nodeAttrEntryName->getCodeLoc());
                         return false;
                     }
-                    if (attrMap.attrMap.find(attrName) != attrMap.attrMap.end()) {
+                    if (attrMap.find(attrName) != nullptr) {
                         msgs->errorAttributesSameName(nodeAttrEntryName->getCodeLoc(), attrName);
                         return false;
                     }
@@ -2388,7 +2525,7 @@ bool Processor::processAttributes(NodeVal &node, bool forceUnescape) {
                         attrVal = NodeVal::moveNoRef(move(attrVal), LifetimeInfo());
                     }
 
-                    attrMap.attrMap.insert({attrName, make_unique<NodeVal>(move(attrVal))});
+                    attrMap.insert(attrName, move(attrVal));
                 }
             }
 
@@ -2423,12 +2560,13 @@ NodeVal Processor::processFncType(const NodeVal &node) {
 
     // arguments
     vector<TypeTable::Id> argTypes;
-    vector<bool> argNoDrops;
+    vector<bool> argNoDrops, argNoAliases;
     const NodeVal &nodeArgs = processWithEscape(node.getChild(indArgs));
     if (nodeArgs.isInvalid()) return NodeVal();
     if (!checkIsRaw(nodeArgs, true)) return NodeVal();
     argTypes.reserve(nodeArgs.getChildrenCnt());
     argNoDrops.reserve(nodeArgs.getChildrenCnt());
+    argNoAliases.reserve(nodeArgs.getChildrenCnt());
     optional<bool> variadic = getAttributeForBool(nodeArgs, "variadic");
     if (!variadic.has_value()) return NodeVal();
     for (size_t i = 0; i < nodeArgs.getChildrenCnt(); ++i) {
@@ -2440,8 +2578,16 @@ NodeVal Processor::processFncType(const NodeVal &node) {
         optional<bool> attrNoDrop = getAttributeForBool(argTy, "noDrop");
         if (!attrNoDrop.has_value()) return NodeVal();
 
+        optional<bool> attrNoAlias = getAttributeForBool(argTy, "noAlias");
+        if (!attrNoAlias.has_value()) return NodeVal();
+        if (attrNoAlias.value() && !typeTable->worksAsTypeAnyP(argTy.getEvalVal().ty())) {
+            msgs->errorArgNoAliasNonPointer(argTy.getCodeLoc());
+            return NodeVal();
+        }
+
         argTypes.push_back(argTy.getEvalVal().ty());
         argNoDrops.push_back(attrNoDrop.value());
+        argNoAliases.push_back(attrNoAlias.value());
     }
 
     // ret type
@@ -2469,6 +2615,7 @@ NodeVal Processor::processFncType(const NodeVal &node) {
         callable.setArgCnt(argTypes.size());
         callable.setArgTypes(argTypes);
         callable.setArgNoDrops(argNoDrops);
+        callable.setArgNoAliases(argNoAliases);
         callable.retType = retType;
         callable.variadic = variadic.value();
         optional<TypeTable::Id> typeOpt = typeTable->addCallable(callable);
@@ -2543,7 +2690,10 @@ NodeVal Processor::processOperUnary(CodeLoc codeLoc, const NodeVal &starting, co
     }
 }
 
-NodeVal Processor::processOperComparison(CodeLoc codeLoc, const std::vector<const NodeVal*> &opers, Oper op) {
+NodeVal Processor::processOperComparison(CodeLoc codeLoc, const NodeVal &starting, const std::vector<const NodeVal*> &opers, Oper op) {
+    optional<FastMathAttrs> attrFastMath = getAttributesForFastMath(starting);
+    if (!attrFastMath.has_value()) return NodeVal();
+
     if (op == Oper::NE && opers.size() > 2) {
         msgs->errorExprCmpNeArgNum(codeLoc);
         return NodeVal();
@@ -2586,11 +2736,11 @@ NodeVal Processor::processOperComparison(CodeLoc codeLoc, const std::vector<cons
         }
 
         if (stillEval) {
-            optional<bool> compSuccess = evaluator->performOperComparison(codeLoc, lhs, rhs, op, signal);
+            optional<bool> compSuccess = evaluator->performOperComparison(codeLoc, lhs, rhs, op, attrFastMath.value(), signal);
             if (!compSuccess.has_value()) return evaluator->performOperComparisonTearDown(codeLoc, false, signal);
             if (compSuccess.value()) break;
         } else {
-            optional<bool> compSuccess = performOperComparison(codeLoc, lhs, rhs, op, signal);
+            optional<bool> compSuccess = performOperComparison(codeLoc, lhs, rhs, op, attrFastMath.value(), signal);
             if (!compSuccess.has_value()) return performOperComparisonTearDown(codeLoc, false, signal);
             if (compSuccess.value()) break;
         }
@@ -2756,6 +2906,9 @@ NodeVal Processor::processOperRegular(CodeLoc codeLoc, const NodeVal &starting,
     optional<bool> attrBare = getAttributeForBool(starting, "bare");
     if (!attrBare.has_value()) return NodeVal();
 
+    optional<FastMathAttrs> attrFastMath = getAttributesForFastMath(starting);
+    if (!attrFastMath.has_value()) return NodeVal();
+
     OperInfo operInfo = operInfos.find(op)->second;
     if (!operInfo.binary) {
         msgs->errorNonBinOp(codeLoc, op);
@@ -2795,6 +2948,7 @@ NodeVal Processor::processOperRegular(CodeLoc codeLoc, const NodeVal &starting,
         OperRegAttrs attrs;
         attrs.noWrap = attrNoWrap.value();
         attrs.bare = attrBare.value();
+        attrs.fastMath = attrFastMath.value();
 
         NodeVal nextLhs;
         if (checkIsEvalTime(lhs, false) && checkIsEvalTime(rhs, false)) {
@@ -2,9 +2,12 @@
 
 #include <optional>
 #include <vector>
+#include "AttrMap.h"
 #include "BlockRaii.h"
 #include "ComparisonSignal.h"
 #include "CompilationMessages.h"
+#include "DropGuardSignal.h"
+#include "FastMathAttrs.h"
 #include "NamePool.h"
 #include "NodeVal.h"
 #include "StringPool.h"
@@ -27,6 +30,7 @@ protected:
     struct OperRegAttrs {
         bool noWrap = false;
         bool bare = false;
+        FastMathAttrs fastMath;
     };
 
     virtual NodeVal performLoad(CodeLoc codeLoc, VarId varId) =0;
@@ -43,10 +47,18 @@ protected:
     virtual bool performExit(CodeLoc codeLoc, SymbolTable::Block block, const NodeVal &cond) =0;
     virtual bool performLoop(CodeLoc codeLoc, SymbolTable::Block block, const NodeVal &cond) =0;
     virtual bool performPass(CodeLoc codeLoc, SymbolTable::Block block, NodeVal val) =0;
+    // Called after a variable was reset to its zero state by a move.
+    virtual bool performMovedFrom(CodeLoc codeLoc, VarId varId) =0;
+    // Wraps the drop of a variable, which may be skipped if it was moved from and not used since.
+    virtual DropGuardSignal performDropGuardSetUp(CodeLoc codeLoc, VarId varId) =0;
+    virtual bool performDropGuardTearDown(CodeLoc codeLoc, DropGuardSignal signal) =0;
     virtual bool performDataDefinition(CodeLoc codeLoc, TypeTable::Id ty) =0;
     virtual NodeVal performCall(CodeLoc codeLoc, CodeLoc codeLocFunc, const NodeVal &func, const std::vector<NodeVal> &args) =0;
     virtual NodeVal performCall(CodeLoc codeLoc, CodeLoc codeLocFunc, FuncId funcId, const std::vector<NodeVal> &args) =0;
     virtual NodeVal performInvoke(CodeLoc codeLoc, MacroId macroId, std::vector<NodeVal> args) =0;
+    // Wraps the processing of the code a macro invocation expanded into.
+    virtual bool performExpansionSetUp(CodeLoc codeLoc, MacroId macroId) =0;
+    virtual bool performExpansionTearDown(CodeLoc codeLoc) =0;
     virtual bool performFunctionDeclaration(CodeLoc codeLoc, FuncValue &func) =0;
     virtual bool performFunctionDefinition(CodeLoc codeLoc, const NodeVal &args, const NodeVal &body, FuncValue &func) =0;
     virtual bool performMacroDefinition(CodeLoc codeLoc, const NodeVal &args, const NodeVal &body, MacroValue &macro) =0;
@@ -56,7 +68,7 @@ protected:
     virtual NodeVal performOperUnaryDeref(CodeLoc codeLoc, const NodeVal &oper, TypeTable::Id resTy) =0;
     virtual ComparisonSignal performOperComparisonSetUp(CodeLoc codeLoc, std::size_t opersCnt) =0;
     // Returns nullopt in case of fail. Otherwise, returns whether the variadic comparison may exit early.
-    virtual std::optional<bool> performOperComparison(CodeLoc codeLoc, const NodeVal &lhs, const NodeVal &rhs, Oper op, ComparisonSignal &signal) =0;
+    virtual std::optional<bool> performOperComparison(CodeLoc codeLoc, const NodeVal &lhs, const NodeVal &rhs, Oper op, FastMathAttrs fastMath, ComparisonSignal &signal) =0;
     virtual NodeVal performOperComparisonTearDown(CodeLoc codeLoc, bool success, ComparisonSignal signal) =0;
     virtual NodeVal performOperAssignment(CodeLoc codeLoc, const NodeVal &lhs, NodeVal rhs) =0;
     // Called for arrays and array pointers.
@@ -111,7 +123,7 @@ private:
     NodeVal processFncType(const NodeVal &node);
     NodeVal processMacType(const NodeVal &node);
     NodeVal processOperUnary(CodeLoc codeLoc, const NodeVal &starting, const NodeVal &oper, Oper op);
-    NodeVal processOperComparison(CodeLoc codeLoc, const std::vector<const NodeVal*> &opers, Oper op);
+    NodeVal processOperComparison(CodeLoc codeLoc, const NodeVal &starting, const std::vector<const NodeVal*> &opers, Oper op);
     NodeVal processOperAssignment(CodeLoc codeLoc, const std::vector<const NodeVal*> &opers);
     NodeVal processOperIndex(CodeLoc codeLoc, const std::vector<const NodeVal*> &opers);
     NodeVal processOperIndexNonArr(CodeLoc codeLoc, const std::vector<const NodeVal*> &opers);
@@ -130,6 +142,10 @@ protected:
     std::optional<bool> getAttributeForBool(const NodeVal &node, const std::string &attrStrName, bool default_ = false);
     // like getAttribute, but can lookup type-specific attributes if node is a type
     std::optional<NodeVal> getAttributeFull(const NodeVal &node, NamePool::Id attrName);
+    // nullopt on error, otherwise fast-math attributes on node combined with those of the current function
+    std::optional<FastMathAttrs> getAttributesForFastMath(const NodeVal &node, bool withCallee = true);
+    // nullopt on error, including conflicting attributes
+    std::optional<FuncValue::OptAttrs> getAttributesForFuncOpt(const NodeVal &node);
 private:
     NodeVal promoteBool(CodeLoc codeLoc, bool b) const;
     NodeVal promoteType(CodeLoc codeLoc, TypeTable::Id ty) const;
@@ -156,12 +172,12 @@ private:
     NodeVal loadUndecidedCallable(const NodeVal &node, const NodeVal &val);
     NodeVal moveNode(CodeLoc codeLoc, NodeVal val, bool noZero);
     NodeVal invoke(CodeLoc codeLoc, MacroId macroId, std::vector<NodeVal> args);
-    bool hasTrivialDrop(TypeTable::Id ty);
     BlockTmpValRaii createTmpValRaii(NodeVal val);
     bool callDropFunc(CodeLoc codeLoc, NodeVal val);
     bool callDropFuncTmpVal(NodeVal val);
     bool callDropFuncs(CodeLoc codeLoc, std::vector<std::variant<VarId, NodeVal>> vals);
 protected:
+    bool hasTrivialDrop(TypeTable::Id ty);
     bool callDropFuncsCurrBlock(CodeLoc codeLoc);
     bool callDropFuncsFromBlockToCurrBlock(CodeLoc codeLoc, NamePool::Id name);
     bool callDropFuncsFromBlockToCurrBlock(CodeLoc codeLoc, std::optional<NamePool::Id> name);
@@ -1,21 +1,88 @@
 #include "ProgramArgs.h"
+#include <charconv>
 #include <filesystem>
 #include <iostream>
+#include "llvm/ProfileData/InstrProfReader.h"
 #include "OrbCompilerConfig.h"
 using namespace std;
 
 optional<ProgramArgs> ProgramArgs::parseArgs(int argc,  char** argv, std::ostream &out) {
     ProgramArgs programArgs;
 
-    bool emitLlvm = false;
+    bool emitLlvm = false, emitBc = false, emitInterface = false, emitDeps = false;
 
     for (int i = 1; i < argc; ++i) {
         string arg = argv[i];
+        programArgs.invocation += arg;
+        programArgs.invocation += '\0';
 
         if (arg == "-c") {
             programArgs.link = false;
         } else if (arg == "-emit-llvm") {
             emitLlvm = true;
+        } else if (arg == "-emit-bc") {
+            emitBc = true;
+        } else if (arg == "-emit-interface") {
+            emitInterface = true;
+        } else if (arg == "-flto" || arg == "-flto=full") {
+            programArgs.lto = LTO_FULL;
+        } else if (arg == "-flto=thin") {
+            programArgs.lto = LTO_THIN;
+        } else if (arg == "-MD") {
+            emitDeps = true;
+        } else if (arg == "-MF") {
+            if (i+1 == argc) {
+                out << "Argument to -MF must be specified." << endl;
+                return nullopt;
+            }
+
+            programArgs.outputDeps = argv[++i];
+            programArgs.invocation += programArgs.outputDeps.value();
+            programArgs.invocation += '\0';
+        } else if (arg == "-skip-if-up-to-date") {
+            programArgs.skipIfUpToDate = true;
+        } else if (arg.rfind("-fcodegen-cache=", 0) == 0) {
+            string cachePath = arg.substr(string("-fcodegen-cache=").size());
+            if (cachePath.empty()) {
+                out << "Empty codegen cache path specified." << endl;
+                return nullopt;
+            }
+            programArgs.codegenCache = move(cachePath);
+        } else if (arg == "-ffast-math") {
+            programArgs.fastMath = true;
+        } else if (arg.rfind("-fimport-workers=", 0) == 0) {
+            unsigned num = 0;
+            const char *begin = arg.data()+string("-fimport-workers=").size(), *end = arg.data()+arg.size();
+            from_chars_result res = from_chars(begin, end, num);
+            if (begin == end || res.ec != errc() || res.ptr != end || num > ProgramArgs::kMaxImportWorkerCnt) {
+                out << "Bad import worker count specified." << endl;
+                return nullopt;
+            }
+
+            programArgs.importWorkerCnt = num;
+        } else if (arg == "-fprofile-generate") {
+            programArgs.profileGenerate = true;
+        } else if (arg.rfind("-fprofile-use=", 0) == 0) {
+            string profilePath = arg.substr(string("-fprofile-use=").size());
+            if (profilePath.empty()) {
+                out << "Empty profile path specified." << endl;
+                return nullopt;
+            }
+            if (!filesystem::exists(profilePath)) {
+                out << "Nonexistent file '" << profilePath << "'." << endl;
+                return nullopt;
+            }
+            // otherwise, LLVM would exit in the middle of compiling
+            auto profileReader = llvm::IndexedInstrProfReader::create(profilePath);
+            if (!profileReader) {
+                out << "Bad profile file '" << profilePath << "': " << llvm::toString(profileReader.takeError()) << "." << endl;
+                return nullopt;
+            }
+            programArgs.profileUse = move(profilePath);
+        } else if (arg == "-g") {
+            programArgs.debugInfo = DI_FULL;
+        } else if (arg == "-gline-tables-only") {
+            programArgs.debugInfo = DI_LINE_TABLES;
         } else if (arg == "-o") {
             if (i+1 == argc) {
                 out << "Argument to -o must be specified." << endl;
@@ -23,11 +90,13 @@ optional<ProgramArgs> ProgramArgs::parseArgs(int argc,  char** argv, std::ostrea
             }
 
             programArgs.outputBin = argv[++i];
+            programArgs.invocation += programArgs.outputBin;
+            programArgs.invocation += '\0';
         } else if (arg.rfind("-O", 0) == 0) {
-            char *end = nullptr;
-            unsigned long num;
-            if (arg.size() > 2) num = strtoul(arg.c_str()+2, &end, 10);
-            if (errno == ERANGE || end != &*arg.end() || num > 3) {
+            unsigned num = 0;
+            const char *begin = arg.data()+2, *end = arg.data()+arg.size();
+            from_chars_result res = from_chars(begin, end, num);
+            if (begin == end || res.ec != errc() || res.ptr != end || num > 3) {
                 out << "Bad optimization level specified." << endl;
                 return nullopt;
             }
@@ -37,7 +106,7 @@ optional<ProgramArgs> ProgramArgs::parseArgs(int argc,  char** argv, std::ostrea
                 return nullopt;
             }
 
-            programArgs.optLvl = static_cast<unsigned>(num);
+            programArgs.optLvl = num;
         } else if (arg.rfind("-I", 0) == 0) {
             string importPath = arg.substr(2);
             if (importPath.empty()) {
@@ -70,7 +139,7 @@ optional<ProgramArgs> ProgramArgs::parseArgs(int argc,  char** argv, std::ostrea
             out << "No source input files specified when linking disabled." << endl;
             failure = true;
         }
-        if (emitLlvm) {
+        if (emitLlvm || emitBc) {
             out << "No source input files specified when emitting LLVM output requested." << endl;
             failure = true;
         }
@@ -78,6 +147,27 @@ optional<ProgramArgs> ProgramArgs::parseArgs(int argc,  char** argv, std::ostrea
         if (failure) return nullopt;
     }
 
+    if (programArgs.profileGenerate && programArgs.profileUse.has_value()) {
+        out << "Profile generation and use cannot both be specified." << endl;
+        return nullopt;
+    }
+
+    if (programArgs.codegenCache.has_value()) {
+        if (!programArgs.link) {
+            out << "Codegen cache cannot be used when linking disabled." << endl;
+            return nullopt;
+        }
+        if (programArgs.lto != LTO_NONE) {
+            out << "Codegen cache cannot be used with link-time optimization." << endl;
+            return nullopt;
+        }
+    }
+
+    if (emitInterface && programArgs.link) {
+        out << "Interface output requires linking disabled." << endl;
+        return nullopt;
+    }
+
     if (!programArgs.link && !programArgs.inputsOther.empty()) {
         out << "Only source input files may be specified when linking disabled." << endl;
         return nullopt;
@@ -92,9 +182,20 @@ optional<ProgramArgs> ProgramArgs::parseArgs(int argc,  char** argv, std::ostrea
         else programArgs.outputBin = firstInputStem + (PLATFORM_WINDOWS ? ".obj" : ".o");
     }
 
+    if (emitInterface) {
+        programArgs.outputInterface = filesystem::path(programArgs.outputBin).replace_extension(".orbi").string();
+    }
+
+    if (emitDeps && !programArgs.outputDeps.has_value()) {
+        programArgs.outputDeps = filesystem::path(programArgs.outputBin).replace_extension(".d").string();
+    }
+
     if (emitLlvm) {
         programArgs.outputLlvm = firstInputStem + ".ll";
     }
+    if (emitBc) {
+        programArgs.outputBc = firstInputStem + ".bc";
+    }
 
     return programArgs;
 }
@@ -108,8 +209,33 @@ Files can be .orb or object files.
 Options:
   -c         Only process and compile, but do not link.
   -emit-llvm Print the LLVM representation into a .ll file.
+  -emit-bc   Write the LLVM bitcode into a .bc file.
+  -emit-interface
+             With -c, also write an .orbi interface next to the output. When the output is later linked in,
+             the interface is imported instead of its sources, as long as it is up to date.
+  -fcodegen-cache=<dir>
+             Compile each function into its own object in <dir>, reusing the ones that did not change.
+  -ffast-math
+             Allow aggressive floating-point optimizations everywhere.
+  -fimport-workers=<num>
+             Read and lex imports on <num> background threads, at most 64. 0 disables them.
+             By default, one less than the hardware threads, at most 4.
+  -flto[=<kind>]
+             Output LLVM bitcode and optimize across all inputs when linking. <kind> is full (default) or thin.
+             Linking is done with LLD.
+  -fprofile-generate
+             Instrument the code to write an execution profile to default_%m.profraw.
+  -fprofile-use=<file>
+             Optimize using the execution profile in <file>, as merged by llvm-profdata.
+  -g         Generate debug info, describing source locations and variables of primitive types.
+  -gline-tables-only
+             Generate debug info, describing only source locations.
   -I<dir>    Add directory <dir> to import search paths.
+  -MD        Write a makefile listing the files the output depends on into a .d file.
+  -MF <file> Write the makefile listing the files the output depends on into <file>.
   -o <file>  Place the binary output into <file>.
   -O<num>    Set the optimization level. -O0, -O1, -O2, and -O3 are valid.
+  -skip-if-up-to-date
+             Do nothing if the output was compiled the same way and none of the files it depends on changed since.
 )orbc_help";
 }
\ No newline at end of file
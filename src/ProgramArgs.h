@@ -5,11 +5,42 @@
 #include <vector>
 
 struct ProgramArgs {
+    enum DebugInfoKind {
+        DI_NONE,
+        DI_LINE_TABLES,
+        DI_FULL
+    };
+
+    static constexpr unsigned kMaxImportWorkerCnt = 64;
+
+    enum LtoKind {
+        LTO_NONE,
+        LTO_THIN,
+        LTO_FULL
+    };
+
     std::vector<std::string> inputsSrc, inputsOther, importPaths;
     std::string outputBin;
-    std::optional<std::string> outputLlvm;
+    std::optional<std::string> outputLlvm, outputBc;
+    // interface for importing the compiled code from other programs
+    std::optional<std::string> outputInterface;
     bool link = true;
     std::optional<unsigned> optLvl;
+    bool fastMath = false;
+    DebugInfoKind debugInfo = DI_NONE;
+    bool profileGenerate = false;
+    std::optional<std::string> profileUse;
+    LtoKind lto = LTO_NONE;
+    // makefile listing the files the output depends on
+    std::optional<std::string> outputDeps;
+    // skips compiling if none of the files the output depends on have changed since
+    bool skipIfUpToDate = false;
+    // all the arguments, for telling whether an output was compiled the same way
+    std::string invocation;
+    // directory of objects of individual functions, reused when the function did not change
+    std::optional<std::string> codegenCache;
+    // threads prefetching imports, decided by the hardware if not given
+    std::optional<unsigned> importWorkerCnt;
 
     static std::optional<ProgramArgs> parseArgs(int argc, char** argv, std::ostream &out);
     static void printHelp(std::ostream &out);
@@ -0,0 +1,100 @@
+#include "SourceManager.h"
+#include <algorithm>
+#include <cstring>
+#include <fstream>
+#include <iterator>
+#include <limits>
+using namespace std;
+
+const vector<size_t>& SourceFile::getLineStarts() const {
+    if (!lineStarts.has_value()) {
+        lineStarts.emplace();
+        if (!contents.empty()) lineStarts->push_back(0);
+        // memchr is vectorized by the C library
+        const char *data = contents.data(), *end = data+contents.size();
+        for (const char *nl = data; nl < end; ++nl) {
+            nl = static_cast<const char*>(memchr(nl, '\n', end-nl));
+            if (nl == nullptr) break;
+            if (nl+1 < end) lineStarts->push_back(nl+1-data);
+        }
+    }
+
+    return lineStarts.value();
+}
+
+string_view SourceFile::getCode(CodeLoc loc) const {
+    if (!contains(loc.start)) return string_view();
+
+    return string_view(contents).substr(loc.start-base, loc.len);
+}
+
+string_view SourceFile::getLine(CodeIndex ln) const {
+    const vector<size_t> &starts = getLineStarts();
+    if (ln == 0 || ln > starts.size()) return string_view();
+
+    size_t start = starts[ln-1];
+    size_t end = ln < starts.size() ? starts[ln]-1 : contents.size();
+    if (end > start && contents[end-1] == '\n') --end;
+    if (end > start && contents[end-1] == '\r') --end;
+
+    return string_view(contents).substr(start, end-start);
+}
+
+CodeOffset SourceFile::getLineStart(CodeIndex ln) const {
+    const vector<size_t> &starts = getLineStarts();
+    if (ln == 0 || ln > starts.size()) return base;
+
+    return base+starts[ln-1];
+}
+
+CodeLocPoint SourceFile::getPoint(CodeOffset offset) const {
+    const vector<size_t> &starts = getLineStarts();
+    size_t offsetInFile = offset-base;
+
+    // the last line starting at or before the offset
+    size_t ind = upper_bound(starts.begin(), starts.end(), offsetInFile)-starts.begin();
+    if (ind == 0) return CodeLocPoint{1, offsetInFile+1};
+
+    return CodeLocPoint{ind, offsetInFile-starts[ind-1]+1};
+}
+
+unique_ptr<SourceFile> SourceManager::read(const string &path) {
+    ifstream in(path, ios::binary);
+    if (!in.is_open()) return nullptr;
+
+    string contents((istreambuf_iterator<char>(in)), istreambuf_iterator<char>());
+    return make_unique<SourceFile>(StringPool::Id(), 0, move(contents));
+}
+
+const SourceFile* SourceManager::add(StringPool::Id file, unique_ptr<SourceFile> src) {
+    if (src == nullptr || files.find(file) != files.end()) return nullptr;
+
+    // the end of each file gets its own offset
+    if (src->getContents().size() >= numeric_limits<CodeOffset>::max()-nextBase) return nullptr;
+
+    src->file = file;
+    src->base = nextBase;
+    nextBase += src->getContents().size()+1;
+    filesOrdered.push_back(src.get());
+
+    return files.insert(make_pair(file, move(src))).first->second.get();
+}
+
+const SourceFile* SourceManager::find(CodeLoc loc) const {
+    // the last file starting at or before the offset
+    auto it = upper_bound(filesOrdered.begin(), filesOrdered.end(), loc.start,
+        [](CodeOffset offset, const SourceFile *src) { return offset < src->getBase(); });
+    if (it == filesOrdered.begin()) return nullptr;
+
+    const SourceFile *src = *(it-1);
+    return src->contains(loc.start) ? src : nullptr;
+}
+
+
+const TokenBuffer* SourceManager::setTokens(StringPool::Id file, TokenBuffer tokens) {
+    auto loc = files.find(file);
+    if (loc == files.end() || loc->second == nullptr) return nullptr;
+
+    loc->second->setTokens(move(tokens));
+    return loc->second->getTokens();
+}
\ No newline at end of file
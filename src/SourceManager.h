@@ -0,0 +1,67 @@
+#pragma once
+
+#include <memory>
+#include <optional>
+#include <string>
+#include <string_view>
+#include <unordered_map>
+#include <vector>
+#include "CodeLoc.h"
+#include "StringPool.h"
+#include "TokenBuffer.h"
+
+class SourceFile {
+    StringPool::Id file;
+    // offset of the first character of the file
+    CodeOffset base;
+    std::string contents;
+    // offsets where lines start, computed when first needed
+    mutable std::optional<std::vector<std::size_t>> lineStarts;
+    std::optional<TokenBuffer> tokens;
+
+    const std::vector<std::size_t>& getLineStarts() const;
+
+    friend class SourceManager;
+
+public:
+    SourceFile(StringPool::Id file, CodeOffset base, std::string contents)
+        : file(file), base(base), contents(std::move(contents)) {}
+
+    StringPool::Id getFile() const { return file; }
+    CodeOffset getBase() const { return base; }
+    const std::string& getContents() const { return contents; }
+    // the end of the file is included, so that it can be pointed to
+    bool contains(CodeOffset offset) const { return offset >= base && offset-base <= contents.size(); }
+    std::string_view getCode(CodeLoc loc) const;
+
+    std::size_t getLineCnt() const { return getLineStarts().size(); }
+    // lines start from 1, the line ending is left out
+    std::string_view getLine(CodeIndex ln) const;
+    CodeOffset getLineStart(CodeIndex ln) const;
+    CodeLocPoint getPoint(CodeOffset offset) const;
+
+    // returns nullptr if the file has not been lexed yet
+    const TokenBuffer* getTokens() const { return tokens.has_value() ? &tokens.value() : nullptr; }
+    void setTokens(TokenBuffer t) { tokens = std::move(t); }
+};
+
+// owns the contents of every source file, so that each is read only once
+class SourceManager {
+    std::unordered_map<StringPool::Id, std::unique_ptr<SourceFile>, StringPool::Id::Hasher> files;
+    // ordered by their bases
+    std::vector<const SourceFile*> filesOrdered;
+    CodeOffset nextBase = 1;
+
+public:
+    // reads a file without adding it, so it may be called from any thread
+    // the file starts at offset 0 until added, returns nullptr if it could not be read
+    static std::unique_ptr<SourceFile> read(const std::string &path);
+    // takes over a file read earlier, giving it its offset
+    // returns nullptr if the file was already added or there is no room for it
+    const SourceFile* add(StringPool::Id file, std::unique_ptr<SourceFile> src);
+
+    // keeps the tokens of a loaded file alongside its contents
+    const TokenBuffer* setTokens(StringPool::Id file, TokenBuffer tokens);
+    // returns the file containing the code loc, or nullptr if it is in none
+    const SourceFile* find(CodeLoc loc) const;
+};
@@ -2,32 +2,31 @@
 #include <iostream>
 using namespace std;
 
-StringPool::StringPool() {
-    next.id = 0;
+StringPool::Id StringPool::idOf(const Interner::Entry *entry) {
+    uint32_t id = entry->id.load(memory_order_relaxed);
+    if (id == Interner::kNoId) {
+        id = static_cast<uint32_t>(strings.size());
+        entry->id.store(id, memory_order_relaxed);
+        strings.push_back(make_pair(entry, nullptr));
+    }
+
+    return Id{id};
 }
 
 StringPool::Id StringPool::add(const string &str) {
-    auto loc = ids.find(str);
-    if (loc != ids.end())
-        return loc->second;
-
-    ids[str] = next;
-    strings[next] = make_pair(str, nullptr);
+    return idOf(interner.intern(str));
+}
 
-    Id ret = next;
-    next.id += 1;
+vector<StringPool::Id> StringPool::commit(const InternBatch &batch) {
+    vector<Id> ids;
+    ids.reserve(batch.getEntries().size());
+    for (const Interner::Entry *entry : batch.getEntries()) ids.push_back(idOf(entry));
 
-    return ret;
+    return ids;
 }
 
 void StringPool::printAll() const {
-    vector<pair<Id::IdType, string>> collected;
-    for (const auto &it : strings) {
-        collected.push_back({it.first.id, it.second.first});
-    }
-    sort(collected.begin(), collected.end());
-
-    for (const auto &it : collected) {
-        cout << it.first << "\t\"" << it.second << "\"" << endl;
+    for (size_t i = 0; i < strings.size(); ++i) {
+        cout << i << "\t\"" << strings[i].first->str << "\"" << endl;
     }
 }
\ No newline at end of file
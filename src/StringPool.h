@@ -2,6 +2,8 @@
 
 #include <string>
 #include <unordered_map>
+#include <vector>
+#include "Interner.h"
 #include "llvm/IR/Constant.h"
 
 class StringPool {
@@ -25,19 +27,23 @@ public:
     };
 
 private:
-    Id next;
+    Interner interner;
+    // indexed by id
+    std::vector<std::pair<const Interner::Entry*, llvm::Constant*>> strings;
 
-    std::unordered_map<Id, std::pair<std::string, llvm::Constant*>, Id::Hasher> strings;
-    std::unordered_map<std::string, Id> ids;
+    Id idOf(const Interner::Entry *entry);
 
 public:
-    StringPool();
-
     Id add(const std::string &str);
-    const std::string& get(Id id) const { return strings.at(id).first; }
+    const std::string& get(Id id) const { return strings[id.id].first->str; }
+
+    // strings may be interned into a batch from other threads, while the ids are handed out only here
+    Interner* getInterner() { return &interner; }
+    // returns the ids of the batch strings, indexed by their local ids
+    std::vector<Id> commit(const InternBatch &batch);
 
-    llvm::Constant* getLlvm(Id id) const { return strings.at(id).second; }
-    void setLlvm(Id id, llvm::Constant *c) { strings[id].second = c; }
+    llvm::Constant* getLlvm(Id id) const { return strings[id.id].second; }
+    void setLlvm(Id id, llvm::Constant *c) { strings[id.id].second = c; }
 
     // for debugging
     void printAll() const;
@@ -42,6 +42,7 @@ SymbolTable::CalleeValueInfo SymbolTable::CalleeValueInfo::make(const FuncValue
     const TypeTable::Callable *call = typeTable->extractCallable(func.getType());
     assert(call != nullptr);
     c.retType = call->retType;
+    c.fastMath = func.fastMath;
     return c;
 }
 
@@ -336,8 +337,9 @@ void SymbolTable::registerDataAttrs(TypeTable::Id ty, AttrMap attrs) {
 }
 
 const AttrMap* SymbolTable::getDataAttrs(TypeTable::Id ty) {
-    if (dataAttrs.find(ty) == dataAttrs.end()) return nullptr;
-    return &dataAttrs.at(ty);
+    auto loc = dataAttrs.find(ty);
+    if (loc == dataAttrs.end()) return nullptr;
+    return &loc->second;
 }
 
 void SymbolTable::registerDropFunc(TypeTable::Id ty, NodeVal func) {
@@ -443,7 +445,7 @@ vector<variant<VarId, NodeVal>> SymbolTable::getValsForDropCurrCallable() {
 }
 
 bool SymbolTable::nameAvailable(NamePool::Id name, const NamePool *namePool, const TypeTable *typeTable, bool forGlobal, bool checkAllScopes) const {
-    if (isReserved(name) || typeTable->isType(name)) return false;
+    if (isReserved(name, namePool) || typeTable->isType(name)) return false;
 
     if (checkAllScopes) {
         if (isVarName(name)) return false;
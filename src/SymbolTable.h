@@ -5,7 +5,9 @@
 #include <variant>
 #include <vector>
 #include "llvm/IR/Instructions.h"
+#include "AttrMap.h"
 #include "CodeLoc.h"
+#include "FastMathAttrs.h"
 #include "NamePool.h"
 #include "NodeVal.h"
 #include "SymbolTableIds.h"
@@ -34,9 +36,24 @@ public:
 };
 
 struct FuncValue : public BaseCallableValue {
+    // hints to the optimizer, only used when compiling
+    struct OptAttrs {
+        bool alwaysInline = false;
+        bool noInline = false;
+        bool hot = false;
+        bool cold = false;
+        bool readNone = false;
+        bool readOnly = false;
+        bool noReturn = false;
+        bool minSize = false;
+    };
+
     bool noNameMangle = false;
     bool defined = false;
     bool isEvalFunc = false;
+    // applied to all floating-point operations in the body
+    FastMathAttrs fastMath;
+    OptAttrs optAttrs;
 
     llvm::Function *llvmFunc = nullptr;
     std::unique_ptr<NodeVal> evalFunc;
@@ -86,6 +103,7 @@ public:
         bool isFunc;
         bool isLlvm, isEval;
         std::optional<TypeTable::Id> retType;
+        FastMathAttrs fastMath;
 
         static CalleeValueInfo make(const FuncValue &func, const TypeTable *typeTable);
 
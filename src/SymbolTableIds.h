@@ -24,7 +24,7 @@ private:
     friend class SymbolTable;
 
     NamePool::Id name;
-    std::size_t index;
+    std::uint32_t index;
 
 public:
     friend bool operator==(const FuncId &l, const FuncId &r)
@@ -39,7 +39,7 @@ private:
     friend class SymbolTable;
 
     NamePool::Id name;
-    std::size_t index;
+    std::uint32_t index;
 
 public:
     friend bool operator==(const MacroId &l, const MacroId &r)
@@ -0,0 +1,105 @@
+#include "TokenBuffer.h"
+#include <algorithm>
+#include <limits>
+using namespace std;
+
+void TokenBuffer::add(const Token &tok, CodeOffset start) {
+    uint32_t payload = 0;
+    switch (tok.type) {
+    case Token::T_NUM:
+        if (tok.num >= 0 && tok.num < numIndexFlag) {
+            payload = static_cast<uint32_t>(tok.num);
+        } else {
+            payload = static_cast<uint32_t>(nums.size())|numIndexFlag;
+            nums.push_back(tok.num);
+        }
+        break;
+    case Token::T_FNUM:
+        payload = static_cast<uint32_t>(fnums.size());
+        fnums.push_back(tok.fnum);
+        break;
+    case Token::T_CHAR:
+        payload = static_cast<unsigned char>(tok.ch);
+        break;
+    case Token::T_BVAL:
+        payload = tok.bval;
+        break;
+    case Token::T_ID:
+        payload = tok.nameId.id;
+        break;
+    case Token::T_STRING:
+        payload = tok.stringId.id;
+        break;
+    default:
+        break;
+    }
+
+    types.push_back(static_cast<uint8_t>(tok.type));
+    payloads.push_back(payload);
+    starts.push_back(start);
+}
+
+void TokenBuffer::addError(LexError error, CodeOffset start, CodeOffset end) {
+    uint32_t len = min<uint32_t>(end-start, numeric_limits<uint32_t>::max()>>8);
+
+    types.push_back(static_cast<uint8_t>(Token::T_UNKNOWN));
+    payloads.push_back(static_cast<uint32_t>(error)|(len<<8));
+    starts.push_back(start);
+}
+
+void TokenBuffer::shrinkToFit() {
+    types.shrink_to_fit();
+    payloads.shrink_to_fit();
+    starts.shrink_to_fit();
+    nums.shrink_to_fit();
+    fnums.shrink_to_fit();
+}
+
+void TokenBuffer::commit(StringPool::Id fileId, CodeOffset base, const vector<NamePool::Id> &names, const vector<StringPool::Id> &strings) {
+    file = fileId;
+
+    for (size_t i = 0; i < types.size(); ++i) {
+        starts[i] += base;
+
+        if (types[i] == Token::T_ID) payloads[i] = names[payloads[i]].id;
+        else if (types[i] == Token::T_STRING) payloads[i] = strings[payloads[i]].id;
+    }
+}
+
+Token TokenBuffer::get(size_t ind) const {
+    Token tok;
+    tok.type = getType(ind);
+    tok.num = 0;
+
+    uint32_t payload = payloads[ind];
+    switch (tok.type) {
+    case Token::T_NUM:
+        if (payload&numIndexFlag) tok.num = nums[payload&~numIndexFlag];
+        else tok.num = payload;
+        break;
+    case Token::T_FNUM:
+        tok.fnum = fnums[payload];
+        break;
+    case Token::T_CHAR:
+        tok.ch = static_cast<char>(payload);
+        break;
+    case Token::T_BVAL:
+        tok.bval = payload != 0;
+        break;
+    case Token::T_ID:
+        tok.nameId = NamePool::Id{payload};
+        break;
+    case Token::T_STRING:
+        tok.stringId = StringPool::Id{payload};
+        break;
+    default:
+        break;
+    }
+
+    return tok;
+}
+
+CodeLoc TokenBuffer::getCodeLoc(size_t ind) const {
+    CodeOffset end = ind+1 < starts.size() ? starts[ind+1] : starts[ind];
+    return CodeLoc::make(starts[ind], end);
+}
\ No newline at end of file
@@ -0,0 +1,64 @@
+#pragma once
+
+#include <cstdint>
+#include <vector>
+#include "CodeLoc.h"
+#include "NamePool.h"
+#include "StringPool.h"
+#include "Token.h"
+
+// all tokens of a file, lexed once and walked by index
+// stored as parallel arrays, a token takes 9 bytes unless it is a float or an int not fitting in 31 bits
+class TokenBuffer {
+public:
+    // why a token could not be lexed, reported once the parser reaches it
+    enum class LexError : std::uint8_t {
+        kBadToken,
+        kBadLiteral,
+        kUnclosedMultilineComment
+    };
+
+private:
+    StringPool::Id file;
+
+    std::vector<std::uint8_t> types;
+    // the value itself for ids, chars, bools and ints in [0, 2^31)
+    // for other ints, an index into nums with numIndexFlag set, for floats, an index into fnums
+    // for T_UNKNOWN, the LexError in the lowest byte and the length of the bad code above it
+    std::vector<std::uint32_t> payloads;
+    // a token spans until the start of the next one, the last is T_END
+    std::vector<CodeOffset> starts;
+
+    static constexpr std::uint32_t numIndexFlag = 1u<<31;
+    std::vector<std::int64_t> nums;
+    std::vector<double> fnums;
+
+public:
+    explicit TokenBuffer(StringPool::Id file) : file(file) {}
+
+    StringPool::Id getFile() const { return file; }
+
+    void add(const Token &tok, CodeOffset start);
+    void addError(LexError error, CodeOffset start, CodeOffset end);
+    void shrinkToFit();
+    // places tokens lexed apart from the source manager at the offset of their file,
+    // replacing ids local to the batches the file was lexed with by their committed ones
+    void commit(StringPool::Id fileId, CodeOffset base, const std::vector<NamePool::Id> &names, const std::vector<StringPool::Id> &strings);
+
+    std::size_t size() const { return types.size(); }
+
+    Token::Type getType(std::size_t ind) const { return static_cast<Token::Type>(types[ind]); }
+    Token get(std::size_t ind) const;
+    LexError getError(std::size_t ind) const { return static_cast<LexError>(payloads[ind]&0xFF); }
+    // the code that could not be lexed, capped in length
+    CodeLoc getErrorCodeLoc(std::size_t ind) const { return CodeLoc{starts[ind], payloads[ind]>>8}; }
+
+    CodeOffset getStart(std::size_t ind) const { return starts[ind]; }
+    CodeLoc getCodeLoc(std::size_t ind) const;
+};
+
+// position of the parser within a file, kept while imports are followed
+struct TokenCursor {
+    const TokenBuffer *tokens;
+    std::size_t ind = 0;
+};
\ No newline at end of file
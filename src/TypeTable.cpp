@@ -4,6 +4,9 @@
 #include <sstream>
 using namespace std;
 
+// both bit-fields share one unit with every compiler
+static_assert(sizeof(TypeTable::Id) == 4);
+
 void TypeTable::Tuple::addElement(TypeTable::Id m) {
     elements.push_back(m);
 }
@@ -63,6 +66,13 @@ void TypeTable::Callable::setArgNoDrops(const vector<bool> &argNoDrops) {
         args[i].noDrop = argNoDrops[i];
 }
 
+void TypeTable::Callable::setArgNoAliases(const vector<bool> &argNoAliases) {
+    assert(args.size() == argNoAliases.size());
+
+    for (size_t i = 0; i < argNoAliases.size(); ++i)
+        args[i].noAlias = argNoAliases[i];
+}
+
 bool TypeTable::Callable::eq(const Callable &other) const {
     if (isFunc != other.isFunc || getArgCnt() != other.getArgCnt() ||
         retType != other.retType || variadic != other.variadic) return false;
@@ -87,15 +97,20 @@ TypeTable::PrimIds TypeTable::shortestFittingPrimTypeF(double x) {
     return std::isinf(x) || std::isnan(x) || (std::abs(x) <= numeric_limits<float>::max()) ? P_F32 : P_F64;
 }
 
-TypeTable::TypeTable() {
+TypeTable::TypeTable(NamePool *namePool) : namePool(namePool) {
     addTypeStr();
 }
 
+void TypeTable::addTypeName(NamePool::Id name, Id id) {
+    typeIds.insert(make_pair(name, id));
+    typeNames.insert(make_pair(id, name));
+    namePool->getInfoForWrite(name).type = true;
+}
+
 void TypeTable::addPrimType(NamePool::Id name, PrimIds primId, llvm::Type *type) {
     Id id(Id::kPrim, primId);
 
-    typeIds.insert(make_pair(name, id));
-    typeNames.insert(make_pair(id, name));
+    addTypeName(name, id);
     primTypes[primId] = type;
 }
 
@@ -116,17 +131,11 @@ TypeTable::Id TypeTable::addTypeDescr(TypeDescr typeDescr) {
 
     TypeDescr normalized = normalize(typeDescr);
 
-    Id id;
-    id.kind = Id::kDescr;
-
     for (size_t i = 0; i < typeDescrs.size(); ++i) {
-        if (typeDescrs[i].first.eq(normalized)) {
-            id.index = i;
-            return id;
-        }
+        if (typeDescrs[i].first.eq(normalized)) return Id(Id::kDescr, i);
     }
 
-    id.index = typeDescrs.size();
+    Id id(Id::kDescr, typeDescrs.size());
     typeDescrs.push_back(make_pair(move(normalized), nullptr));
     return id;
 }
@@ -138,16 +147,11 @@ optional<TypeTable::Id> TypeTable::addTuple(Tuple tup) {
 
     for (size_t i = 0; i < tuples.size(); ++i) {
         if (tup.eq(tuples[i].first)) {
-            Id id;
-            id.kind = Id::kTuple;
-            id.index = i;
-            return id;
+            return Id(Id::kTuple, i);
         }
     }
 
-    Id id;
-    id.kind = Id::kTuple;
-    id.index = tuples.size();
+    Id id(Id::kTuple, tuples.size());
 
     tuples.push_back(make_pair(move(tup), nullptr));
 
@@ -157,12 +161,9 @@ optional<TypeTable::Id> TypeTable::addTuple(Tuple tup) {
 optional<TypeTable::Id> TypeTable::addExplicitType(ExplicitType c) {
     if (typeIds.find(c.name) != typeIds.end()) return nullopt;
 
-    Id id;
-    id.kind = Id::kExplicit;
-    id.index = explicitTypes.size();
+    Id id(Id::kExplicit, explicitTypes.size());
 
-    typeIds.insert(make_pair(c.name, id));
-    typeNames.insert(make_pair(id, c.name));
+    addTypeName(c.name, id);
 
     explicitTypes.push_back(make_pair(c, nullptr));
 
@@ -183,12 +184,9 @@ optional<TypeTable::Id> TypeTable::addDataType(DataType data) {
 
         return loc->second;
     } else {
-        Id id;
-        id.kind = Id::kData;
-        id.index = dataTypes.size();
+        Id id(Id::kData, dataTypes.size());
 
-        typeIds.insert(make_pair(data.name, id));
-        typeNames.insert(make_pair(id, data.name));
+        addTypeName(data.name, id);
 
         dataTypes.push_back(make_pair(move(data), nullptr));
 
@@ -199,16 +197,11 @@ optional<TypeTable::Id> TypeTable::addDataType(DataType data) {
 TypeTable::Id TypeTable::addCallable(Callable call) {
     for (size_t i = 0; i < callables.size(); ++i) {
         if (call.eq(callables[i].first)) {
-            Id id;
-            id.kind = Id::kCallable;
-            id.index = i;
-            return id;
+            return Id(Id::kCallable, i);
         }
     }
 
-    Id id;
-    id.kind = Id::kCallable;
-    id.index = callables.size();
+    Id id(Id::kCallable, callables.size());
 
     callables.push_back(make_pair(move(call), nullptr));
 
@@ -337,8 +330,9 @@ TypeTable::Id TypeTable::addCallableSig(const Callable &call) {
     Callable sig(call);
     for (auto &it : sig.args) {
         if (isTypeDescr(it.ty)) it.ty = addTypeDescrForSig(getTypeDescr(it.ty));
-        // noDrop not part of sig
+        // noDrop and noAlias not part of sig
         it.noDrop = false;
+        it.noAlias = false;
     }
     // ret type is not part of sig
     sig.retType.reset();
@@ -359,7 +353,7 @@ void TypeTable::addTypeStr() {
 }
 
 llvm::Type* TypeTable::getLlvmType(Id id) {
-    switch (id.kind) {
+    switch (id.getKind()) {
     case Id::kPrim: return primTypes[id.index];
     case Id::kTuple: return tuples[id.index].second;
     case Id::kDescr: return typeDescrs[id.index].second;
@@ -371,7 +365,7 @@ llvm::Type* TypeTable::getLlvmType(Id id) {
 }
 
 void TypeTable::setLlvmType(Id id, llvm::Type *type) {
-    switch (id.kind) {
+    switch (id.getKind()) {
     case Id::kPrim: primTypes[id.index] = type; break;
     case Id::kTuple: tuples[id.index].second = type; break;
     case Id::kDescr: typeDescrs[id.index].second = type; break;
@@ -455,7 +449,7 @@ TypeTable::Id TypeTable::extractExplicitTypeBaseType(Id t) const {
 }
 
 bool TypeTable::isValidType(Id t) const {
-    switch (t.kind) {
+    switch (t.getKind()) {
     case Id::kPrim: return t.index < primTypes.size();
     case Id::kTuple: return t.index < tuples.size();
     case Id::kDescr: return t.index < typeDescrs.size();
@@ -467,7 +461,7 @@ bool TypeTable::isValidType(Id t) const {
 }
 
 bool TypeTable::isType(NamePool::Id name) const {
-    return typeIds.find(name) != typeIds.end();
+    return namePool->getInfo(name).type;
 }
 
 optional<TypeTable::Id> TypeTable::getTypeId(NamePool::Id name) const {
@@ -1066,8 +1060,9 @@ optional<string> TypeTable::makeBinString(Id t, const NamePool *namePool, bool m
                 if (!str.has_value()) return nullopt;
                 ss << str.value();
 
-                // noDrop is not part of sig, so fetch from original
+                // noDrop and noAlias are not part of sig, so fetch from original
                 if (callable.getArgNoDrop(i)) ss << "$!";
+                if (callable.getArgNoAlias(i)) ss << "$&";
             }
         }
 
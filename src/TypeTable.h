@@ -1,6 +1,7 @@
 #pragma once
 
 #include <array>
+#include <cassert>
 #include <optional>
 #include <unordered_map>
 #include <vector>
@@ -23,10 +24,18 @@ public:
             kCallable
         };
 
-        Kind kind;
-        std::size_t index;
+        // packed, as every evaluated value carries one
+        // not declared as Kind, as MSVC would read the bit-field back signed
+        std::uint32_t kind : 3;
+        std::uint32_t index : 29;
 
-        Id(Kind k, std::size_t ind) : kind(k), index(ind) {}
+        static constexpr std::size_t kMaxIndexCnt = std::size_t(1)<<29;
+
+        Id(Kind k, std::size_t ind) : kind(static_cast<std::uint32_t>(k)), index(static_cast<std::uint32_t>(ind)) {
+            assert(ind < kMaxIndexCnt && "Too many types to fit into a type id.");
+        }
+
+        Kind getKind() const { return static_cast<Kind>(kind); }
 
     public:
         Id() {}
@@ -97,6 +106,9 @@ public:
     };
 
     struct DataType {
+        // the largest alignment LLVM supports
+        static constexpr std::uint64_t kMaxAlignment = std::uint64_t(1)<<29;
+
         struct ElemEntry {
             NamePool::Id name;
             TypeTable::Id type;
@@ -106,6 +118,9 @@ public:
         bool defined = false;
         NamePool::Id name;
         std::vector<ElemEntry> elements;
+        bool packed = false;
+        // minimum alignment in bytes, zero means natural alignment
+        std::uint64_t alignment = 0;
 
         DataType() {}
         DataType(NamePool::Id name, std::vector<ElemEntry> elems) : name(name), elements(std::move(elems)) {}
@@ -120,9 +135,10 @@ public:
         struct ArgEntry {
             TypeTable::Id ty;
             bool noDrop = false;
+            bool noAlias = false;
 
             bool eq(const ArgEntry &other) const
-            { return ty == other.ty && noDrop == other.noDrop; }
+            { return ty == other.ty && noDrop == other.noDrop && noAlias == other.noAlias; }
         };
 
         std::vector<ArgEntry> args;
@@ -146,6 +162,11 @@ public:
         // assumed to have the same arg size
         void setArgNoDrops(const std::vector<bool> &argNoDrops);
 
+        bool getArgNoAlias(std::size_t ind) const { return args[ind].noAlias; }
+        void setArgNoAlias(std::size_t ind, bool b) { args[ind].noAlias = b; }
+        // assumed to have the same arg size
+        void setArgNoAliases(const std::vector<bool> &argNoAliases);
+
         bool hasRet() const { return retType.has_value(); }
 
         bool eq(const Callable &other) const;
@@ -190,6 +211,10 @@ private:
 
     std::unordered_map<NamePool::Id, Id, NamePool::Id::Hasher> typeIds;
     std::unordered_map<Id, NamePool::Id, Id::Hasher> typeNames;
+    // type names are also marked in the pool, so that isType does not need to hash
+    NamePool *namePool;
+
+    void addTypeName(NamePool::Id name, Id id);
 
     template <typename T>
     bool worksAsTypeDescrSatisfyingCondition(Id t, T cond) const;
@@ -198,7 +223,7 @@ private:
     void addTypeStr();
 
 public:
-    TypeTable();
+    explicit TypeTable(NamePool *namePool);
 
     void addPrimType(NamePool::Id name, PrimIds primId, llvm::Type *type);
     // if typeDescr is secretly a base type, that type's Id is returned instead
@@ -0,0 +1,162 @@
+#include "charClasses.h"
+#include <bit>
+#if (defined(__x86_64__) || defined(__i386__)) && (defined(__GNUC__) || defined(__clang__))
+#define CHAR_SCAN_X86 1
+#include <immintrin.h>
+#else
+#define CHAR_SCAN_X86 0
+#endif
+using namespace std;
+
+static constexpr string_view idSpecialChars = "=+-*/%<>&|^!~[]._?";
+static constexpr string_view numLitChars = "0123456789abcdefABCDEF.xXpP_-";
+
+static constexpr array<uint8_t, 256> makeCharClasses() {
+    array<uint8_t, 256> classes{};
+
+    for (size_t i = 0; i < classes.size(); ++i) {
+        char ch = static_cast<char>(i);
+        bool alnum = (ch >= '0' && ch <= '9') || (ch >= 'a' && ch <= 'z') || (ch >= 'A' && ch <= 'Z');
+        // \t, \n, \v, \f, \r
+        bool spaceCtrl = ch >= '\t' && ch <= '\r';
+
+        if (ch == ' ' || spaceCtrl) classes[i] |= CC_SPACE;
+        if (alnum || idSpecialChars.find(ch) != idSpecialChars.npos) classes[i] |= CC_ID;
+        if (numLitChars.find(ch) != numLitChars.npos) classes[i] |= CC_NUM_LIT;
+        if (!spaceCtrl && ch != '\'' && ch != '\"' && ch != '\\') classes[i] |= CC_LIT_PLAIN;
+        if (ch != '$') classes[i] |= CC_COMMENT_PLAIN;
+    }
+
+    return classes;
+}
+
+static constexpr array<uint8_t, 256> charClassesInit = makeCharClasses();
+
+const array<uint8_t, 256> charClasses = charClassesInit;
+
+static size_t scanScalar(string_view str, size_t from, CharClass cls) {
+    size_t i = from;
+    while (i < str.size() && isCharClass(str[i], cls)) ++i;
+    return i;
+}
+
+#if CHAR_SCAN_X86
+// a class split into two tables indexed by the low and the high nibble of a character,
+// the character is in the class if its two entries have a bit in common
+struct NibbleTables {
+    array<uint8_t, 16> lo{}, hi{};
+    bool valid = false;
+};
+
+static constexpr NibbleTables makeNibbleTables(CharClass cls) {
+    NibbleTables tables;
+
+    // high nibbles with the same set of low nibbles in the class share a bit
+    array<uint16_t, 8> patterns{};
+    size_t patternCnt = 0;
+    for (size_t h = 0; h < 16; ++h) {
+        uint16_t pattern = 0;
+        for (size_t l = 0; l < 16; ++l) {
+            if ((charClassesInit[h*16+l] & cls) != 0) pattern |= 1<<l;
+        }
+        if (pattern == 0) continue;
+
+        size_t bit = 0;
+        while (bit < patternCnt && patterns[bit] != pattern) ++bit;
+        if (bit == patternCnt) {
+            if (patternCnt == patterns.size()) return NibbleTables();
+            patterns[patternCnt++] = pattern;
+        }
+
+        tables.hi[h] |= 1<<bit;
+        for (size_t l = 0; l < 16; ++l) {
+            if ((pattern & (1<<l)) != 0) tables.lo[l] |= 1<<bit;
+        }
+    }
+
+    tables.valid = true;
+    return tables;
+}
+
+// indexed by the bit of the class
+static constexpr array<NibbleTables, 5> nibbleTables = {
+    makeNibbleTables(CC_SPACE),
+    makeNibbleTables(CC_ID),
+    makeNibbleTables(CC_NUM_LIT),
+    makeNibbleTables(CC_LIT_PLAIN),
+    makeNibbleTables(CC_COMMENT_PLAIN)
+};
+
+static_assert(nibbleTables[0].valid && nibbleTables[1].valid && nibbleTables[2].valid &&
+    nibbleTables[3].valid && nibbleTables[4].valid);
+
+__attribute__((target("sse4.2")))
+static size_t scanSse42(string_view str, size_t from, CharClass cls) {
+    const NibbleTables &tables = nibbleTables[countr_zero(static_cast<unsigned>(cls))];
+    const __m128i lo = _mm_loadu_si128(reinterpret_cast<const __m128i*>(tables.lo.data()));
+    const __m128i hi = _mm_loadu_si128(reinterpret_cast<const __m128i*>(tables.hi.data()));
+    const __m128i nibbleMask = _mm_set1_epi8(0x0F);
+
+    size_t i = from;
+    for (; i+16 <= str.size(); i += 16) {
+        __m128i chars = _mm_loadu_si128(reinterpret_cast<const __m128i*>(str.data()+i));
+        __m128i loBits = _mm_shuffle_epi8(lo, _mm_and_si128(chars, nibbleMask));
+        __m128i hiBits = _mm_shuffle_epi8(hi, _mm_and_si128(_mm_srli_epi16(chars, 4), nibbleMask));
+        __m128i notIn = _mm_cmpeq_epi8(_mm_and_si128(loBits, hiBits), _mm_setzero_si128());
+
+        unsigned mask = static_cast<unsigned>(_mm_movemask_epi8(notIn));
+        if (mask != 0) return i+countr_zero(mask);
+    }
+
+    return scanScalar(str, i, cls);
+}
+
+__attribute__((target("avx2")))
+static size_t scanAvx2(string_view str, size_t from, CharClass cls) {
+    const NibbleTables &tables = nibbleTables[countr_zero(static_cast<unsigned>(cls))];
+    // shuffles look up within each 128-bit lane, so the tables are repeated in both
+    const __m256i lo = _mm256_broadcastsi128_si256(_mm_loadu_si128(reinterpret_cast<const __m128i*>(tables.lo.data())));
+    const __m256i hi = _mm256_broadcastsi128_si256(_mm_loadu_si128(reinterpret_cast<const __m128i*>(tables.hi.data())));
+    const __m256i nibbleMask = _mm256_set1_epi8(0x0F);
+
+    size_t i = from;
+    for (; i+32 <= str.size(); i += 32) {
+        __m256i chars = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(str.data()+i));
+        __m256i loBits = _mm256_shuffle_epi8(lo, _mm256_and_si256(chars, nibbleMask));
+        __m256i hiBits = _mm256_shuffle_epi8(hi, _mm256_and_si256(_mm256_srli_epi16(chars, 4), nibbleMask));
+        __m256i notIn = _mm256_cmpeq_epi8(_mm256_and_si256(loBits, hiBits), _mm256_setzero_si256());
+
+        unsigned mask = static_cast<unsigned>(_mm256_movemask_epi8(notIn));
+        if (mask != 0) return i+countr_zero(mask);
+    }
+
+    return scanSse42(str, i, cls);
+}
+
+enum class ScanImpl {
+    kScalar,
+    kSse42,
+    kAvx2
+};
+
+static ScanImpl pickScanImpl() {
+    __builtin_cpu_init();
+    if (__builtin_cpu_supports("avx2")) return ScanImpl::kAvx2;
+    if (__builtin_cpu_supports("sse4.2")) return ScanImpl::kSse42;
+    return ScanImpl::kScalar;
+}
+
+static const ScanImpl scanImpl = pickScanImpl();
+#endif
+
+size_t scanCharClass(string_view str, size_t from, CharClass cls) {
+#if CHAR_SCAN_X86
+    // most runs are short, not worth setting up the registers for
+    if (from+16 <= str.size() && isCharClass(str[from], cls)) {
+        if (scanImpl == ScanImpl::kAvx2) return scanAvx2(str, from, cls);
+        if (scanImpl == ScanImpl::kSse42) return scanSse42(str, from, cls);
+    }
+#endif
+
+    return scanScalar(str, from, cls);
+}
\ No newline at end of file
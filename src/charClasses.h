@@ -0,0 +1,28 @@
+#pragma once
+
+#include <array>
+#include <cstdint>
+#include <string_view>
+
+// classes of characters the lexer scans runs of, a character may belong to several
+enum CharClass : std::uint8_t {
+    CC_SPACE = 1<<0,
+    // characters identifiers consist of
+    CC_ID = 1<<1,
+    // characters numeric literals consist of, validated later
+    CC_NUM_LIT = 1<<2,
+    // characters taken as they are in char and string literals
+    CC_LIT_PLAIN = 1<<3,
+    // characters that cannot end a multiline comment
+    CC_COMMENT_PLAIN = 1<<4
+};
+
+extern const std::array<std::uint8_t, 256> charClasses;
+
+inline bool isCharClass(char ch, CharClass cls) {
+    return (charClasses[static_cast<unsigned char>(ch)] & cls) != 0;
+}
+
+// returns the index of the first character at or after from that is not in the class, or str.size() if none
+// vectorized when the CPU allows it
+std::size_t scanCharClass(std::string_view str, std::size_t from, CharClass cls);
\ No newline at end of file
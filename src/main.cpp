@@ -21,6 +21,10 @@ int main(int argc,  char** argv) {
         return BAD_ARGS;
     }
 
+    if (programArgs.value().skipIfUpToDate && CompilationOrchestrator::isUpToDate(programArgs.value())) {
+        return 0;
+    }
+
     CompilationOrchestrator co(move(programArgs.value()), cerr);
 
     try {
@@ -35,6 +39,7 @@ int main(int argc,  char** argv) {
         }
 
         co.printout();
+        if (!co.printoutDeps()) return COMPILE_FAIL;
     } catch (ExceptionEvaluatorJump ex) {
         cerr << "Something went wrong when compiling!" << endl;
         return INTERNAL;
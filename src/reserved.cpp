@@ -1,10 +1,12 @@
 #include "reserved.h"
+#include <array>
 #include <cassert>
 using namespace std;
 
-std::unordered_map<NamePool::Id, Meaningful, NamePool::Id::Hasher> meaningfuls;
-std::unordered_map<NamePool::Id, Keyword, NamePool::Id::Hasher> keywords;
-std::unordered_map<NamePool::Id, Oper, NamePool::Id::Hasher> opers;
+// names by the value they were set for, the other way around is kept in NamePool
+static array<optional<NamePool::Id>, static_cast<size_t>(Meaningful::UNKNOWN)> meaningfulNameIds;
+static array<optional<NamePool::Id>, static_cast<size_t>(Keyword::UNKNOWN)> keywordNameIds;
+static array<optional<NamePool::Id>, static_cast<size_t>(Oper::UNKNOWN)> operNameIds;
 
 const unordered_map<Oper, OperInfo> operInfos = {
     {Oper::ASGN, {.binary=true}},
@@ -29,88 +31,93 @@ const unordered_map<Oper, OperInfo> operInfos = {
     {Oper::IND, {.binary=true}}
 };
 
-bool isMeaningful(NamePool::Id name) {
-    return meaningfuls.find(name) != meaningfuls.end();
+void setMeaningful(NamePool::Id name, Meaningful m, NamePool *namePool) {
+    namePool->getInfoForWrite(name).meaningful = static_cast<uint8_t>(m);
+    meaningfulNameIds[static_cast<size_t>(m)] = name;
 }
 
-optional<Meaningful> getMeaningful(NamePool::Id name) {
-    auto loc = meaningfuls.find(name);
-    if (loc == meaningfuls.end()) return nullopt;
-    return loc->second;
+void setKeyword(NamePool::Id name, Keyword k, NamePool *namePool) {
+    namePool->getInfoForWrite(name).keyword = static_cast<uint8_t>(k);
+    keywordNameIds[static_cast<size_t>(k)] = name;
 }
 
-NamePool::Id getMeaningfulNameId(Meaningful m) {
-    for (const auto &it : meaningfuls) {
-        if (it.second == m) return it.first;
-    }
+void setOper(NamePool::Id name, Oper o, NamePool *namePool) {
+    namePool->getInfoForWrite(name).oper = static_cast<uint8_t>(o);
+    operNameIds[static_cast<size_t>(o)] = name;
+}
 
-    assert(false && "getMeaningfulNameId failed to find!");
-    return NamePool::Id();
+bool isMeaningful(NamePool::Id name, const NamePool *namePool) {
+    return namePool->getInfo(name).meaningful != NamePool::Info::kNone;
 }
 
-bool isMeaningful(NamePool::Id name, Meaningful m) {
-    optional<Meaningful> opt = getMeaningful(name);
-    return opt.has_value() && opt.value() == m;
+optional<Meaningful> getMeaningful(NamePool::Id name, const NamePool *namePool) {
+    uint8_t m = namePool->getInfo(name).meaningful;
+    if (m == NamePool::Info::kNone) return nullopt;
+    return static_cast<Meaningful>(m);
 }
 
-bool isKeyword(NamePool::Id name) {
-    return keywords.find(name) != keywords.end();
+NamePool::Id getMeaningfulNameId(Meaningful m) {
+    const optional<NamePool::Id> &name = meaningfulNameIds[static_cast<size_t>(m)];
+    assert(name.has_value() && "getMeaningfulNameId failed to find!");
+    return name.value_or(NamePool::Id());
 }
 
-optional<Keyword> getKeyword(NamePool::Id name) {
-    auto loc = keywords.find(name);
-    if (loc == keywords.end()) return nullopt;
-    return loc->second;
+bool isMeaningful(NamePool::Id name, Meaningful m, const NamePool *namePool) {
+    return namePool->getInfo(name).meaningful == static_cast<uint8_t>(m);
 }
 
-NamePool::Id getKeywordNameId(Keyword k) {
-    for (const auto &it : keywords) {
-        if (it.second == k) return it.first;
-    }
+bool isKeyword(NamePool::Id name, const NamePool *namePool) {
+    return namePool->getInfo(name).keyword != NamePool::Info::kNone;
+}
 
-    assert(false && "getKeywordNameId failed to find!");
-    return NamePool::Id();
+optional<Keyword> getKeyword(NamePool::Id name, const NamePool *namePool) {
+    uint8_t k = namePool->getInfo(name).keyword;
+    if (k == NamePool::Info::kNone) return nullopt;
+    return static_cast<Keyword>(k);
 }
 
-bool isKeyword(NamePool::Id name, Keyword k) {
-    optional<Keyword> opt = getKeyword(name);
-    return opt.has_value() && opt.value() == k;
+NamePool::Id getKeywordNameId(Keyword k) {
+    const optional<NamePool::Id> &name = keywordNameIds[static_cast<size_t>(k)];
+    assert(name.has_value() && "getKeywordNameId failed to find!");
+    return name.value_or(NamePool::Id());
 }
 
-bool isOper(NamePool::Id name) {
-    return opers.find(name) != opers.end();
+bool isKeyword(NamePool::Id name, Keyword k, const NamePool *namePool) {
+    return namePool->getInfo(name).keyword == static_cast<uint8_t>(k);
 }
 
-optional<Oper> getOper(NamePool::Id name) {
-    auto loc = opers.find(name);
-    if (loc == opers.end()) return nullopt;
-    return loc->second;
+bool isOper(NamePool::Id name, const NamePool *namePool) {
+    return namePool->getInfo(name).oper != NamePool::Info::kNone;
 }
 
-NamePool::Id getOperNameId(Oper o) {
-    for (const auto &it : opers) {
-        if (it.second == o) return it.first;
-    }
+optional<Oper> getOper(NamePool::Id name, const NamePool *namePool) {
+    uint8_t o = namePool->getInfo(name).oper;
+    if (o == NamePool::Info::kNone) return nullopt;
+    return static_cast<Oper>(o);
+}
 
-    assert(false && "getOperNameId failed to find!");
-    return NamePool::Id();
+NamePool::Id getOperNameId(Oper o) {
+    const optional<NamePool::Id> &name = operNameIds[static_cast<size_t>(o)];
+    assert(name.has_value() && "getOperNameId failed to find!");
+    return name.value_or(NamePool::Id());
 }
 
-bool isOper(NamePool::Id name, Oper o) {
-    optional<Oper> opt = getOper(name);
-    return opt.has_value() && opt.value() == o;
+bool isOper(NamePool::Id name, Oper o, const NamePool *namePool) {
+    return namePool->getInfo(name).oper == static_cast<uint8_t>(o);
 }
 
-bool isReserved(NamePool::Id name) {
-    return isKeyword(name) || isOper(name) || isTypeDescrDecor(name);
+bool isReserved(NamePool::Id name, const NamePool *namePool) {
+    NamePool::Info info = namePool->getInfo(name);
+    return info.keyword != NamePool::Info::kNone || info.oper != NamePool::Info::kNone ||
+        (info.meaningful != NamePool::Info::kNone && isTypeDescrDecor(static_cast<Meaningful>(info.meaningful)));
 }
 
 bool isTypeDescrDecor(Meaningful m) {
     return m == Meaningful::CN || m == Meaningful::ASTERISK || m == Meaningful::SQUARE;
 }
 
-bool isTypeDescrDecor(NamePool::Id name) {
-    optional<Meaningful> m = getMeaningful(name);
+bool isTypeDescrDecor(NamePool::Id name, const NamePool *namePool) {
+    optional<Meaningful> m = getMeaningful(name, namePool);
     if (!m.has_value()) return false;
     return isTypeDescrDecor(m.value());
 }
\ No newline at end of file
@@ -68,23 +68,25 @@ struct OperInfo {
     bool comparison = false;
 };
 
-extern std::unordered_map<NamePool::Id, Meaningful, NamePool::Id::Hasher> meaningfuls;
-extern std::unordered_map<NamePool::Id, Keyword, NamePool::Id::Hasher> keywords;
-extern std::unordered_map<NamePool::Id, Oper, NamePool::Id::Hasher> opers;
 extern const std::unordered_map<Oper, OperInfo> operInfos;
 
-bool isMeaningful(NamePool::Id name);
-std::optional<Meaningful> getMeaningful(NamePool::Id name);
+// marks the name in the pool, each meaningful, keyword and oper is expected to be set once
+void setMeaningful(NamePool::Id name, Meaningful m, NamePool *namePool);
+void setKeyword(NamePool::Id name, Keyword k, NamePool *namePool);
+void setOper(NamePool::Id name, Oper o, NamePool *namePool);
+
+bool isMeaningful(NamePool::Id name, const NamePool *namePool);
+std::optional<Meaningful> getMeaningful(NamePool::Id name, const NamePool *namePool);
 NamePool::Id getMeaningfulNameId(Meaningful m);
-bool isMeaningful(NamePool::Id name, Meaningful m);
-bool isKeyword(NamePool::Id name);
-std::optional<Keyword> getKeyword(NamePool::Id name);
+bool isMeaningful(NamePool::Id name, Meaningful m, const NamePool *namePool);
+bool isKeyword(NamePool::Id name, const NamePool *namePool);
+std::optional<Keyword> getKeyword(NamePool::Id name, const NamePool *namePool);
 NamePool::Id getKeywordNameId(Keyword k);
-bool isKeyword(NamePool::Id name, Keyword k);
-bool isOper(NamePool::Id name);
-std::optional<Oper> getOper(NamePool::Id name);
+bool isKeyword(NamePool::Id name, Keyword k, const NamePool *namePool);
+bool isOper(NamePool::Id name, const NamePool *namePool);
+std::optional<Oper> getOper(NamePool::Id name, const NamePool *namePool);
 NamePool::Id getOperNameId(Oper o);
-bool isOper(NamePool::Id name, Oper o);
-bool isReserved(NamePool::Id name);
+bool isOper(NamePool::Id name, Oper o, const NamePool *namePool);
+bool isReserved(NamePool::Id name, const NamePool *namePool);
 bool isTypeDescrDecor(Meaningful m);
-bool isTypeDescrDecor(NamePool::Id name);
\ No newline at end of file
+bool isTypeDescrDecor(NamePool::Id name, const NamePool *namePool);
\ No newline at end of file
@@ -1,13 +1,14 @@
 #include "unescape.h"
+#include "charClasses.h"
 #include "utils.h"
 using namespace std;
 
-pair<char, bool> nextCh(const string &str, size_t &index) {
+pair<char, bool> nextCh(string_view str, size_t &index) {
     if (index >= str.size()) return {char(), false};
     return {str[index++], true};
 }
 
-pair<int, bool> nextHex(const string &str, size_t &index) {
+pair<int, bool> nextHex(string_view str, size_t &index) {
     pair<char, bool> ch = nextCh(str, index);
     if (ch.second == false) return {0, false};
 
@@ -26,7 +27,7 @@ pair<int, bool> nextHex(const string &str, size_t &index) {
     return hex;
 }
 
-UnescapePayload unescape(const string &str, std::size_t indexStarting, bool isSingleQuote) {
+UnescapePayload unescape(string_view str, std::size_t indexStarting, bool isSingleQuote) {
     string out;
     size_t ind = indexStarting;
     size_t afterLastSuccessful;
@@ -35,6 +36,14 @@ UnescapePayload unescape(const string &str, std::size_t indexStarting, bool isSi
 
         if (ind >= str.size()) return UnescapePayload(out, afterLastSuccessful, UnescapePayload::Status::SuccessUnclosed);
 
+        // chars needing no unescaping are copied in bulk
+        size_t plainEnd = scanCharClass(str, ind, CC_LIT_PLAIN);
+        if (plainEnd > ind) {
+            out.append(str.substr(ind, plainEnd-ind));
+            ind = plainEnd;
+            continue;
+        }
+
         pair<char, bool> ch = nextCh(str, ind);
         if (ch.second == false) break;
 
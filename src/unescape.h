@@ -1,6 +1,7 @@
 #pragma once
 
 #include <string>
+#include <string_view>
 
 struct UnescapePayload {
     enum Status {
@@ -27,4 +28,4 @@ struct UnescapePayload {
 //
 // Unescape sequences are: \', \", \?, \\, \a, \b, \f, \n, \r, \t, \v, \0,
 // and \xNN (where N is a hex digit in [0-9a-fA-F]).
-UnescapePayload unescape(const std::string &str, std::size_t indexStarting, bool isSingleQuote);
+UnescapePayload unescape(std::string_view str, std::size_t indexStarting, bool isSingleQuote);
@@ -10,6 +10,10 @@ bool between(T x, T lo, T hi) {
     return x >= lo && x <= hi;
 }
 
+inline bool isPowOf2(std::uint64_t x) {
+    return x != 0 && (x&(x-1)) == 0;
+}
+
 inline std::size_t leNiceHasheFunctione(std::size_t x, std::size_t y) {
     return (17*31+x)*31+y;
 }
@@ -0,0 +1,57 @@
+import glob
+import os
+import platform
+import statistics
+import subprocess
+import sys
+import time
+
+ORBC_EXE = sys.argv[1]
+RUNS = int(sys.argv[2]) if len(sys.argv) > 2 else 5
+
+BENCH_DIR = 'benchmarks'
+BENCH_BIN_DIR = 'bin'
+BENCH_LIB_DIR = '../libs/'
+
+
+def run_benchmark(case):
+    src_file = BENCH_DIR + '/' + case + '.orb'
+    lib_path = '-I' + BENCH_LIB_DIR
+    exe_file = BENCH_BIN_DIR + '/' + case
+    if platform.system() == 'Windows':
+        exe_file += '.exe'
+
+    start = time.perf_counter()
+    result = subprocess.run([ORBC_EXE, src_file, lib_path, '-o', exe_file])
+    compile_time = time.perf_counter() - start
+    if result.returncode != 0:
+        print('Benchmark failed to compile: ' + case)
+        return False
+
+    run_times = []
+    for _ in range(RUNS):
+        start = time.perf_counter()
+        subprocess.run(exe_file, stdout=subprocess.DEVNULL)
+        run_times.append(time.perf_counter() - start)
+
+    print('{}: compile {:.3f}s, run min {:.3f}s, median {:.3f}s'.format(
+        case, compile_time, min(run_times), statistics.median(run_times)))
+
+    return True
+
+
+if __name__ == "__main__":
+    if not os.path.exists(BENCH_BIN_DIR):
+        os.mkdir(BENCH_BIN_DIR)
+
+    bench_src_files = sorted(glob.glob(BENCH_DIR + '/bench*.orb'))
+    bench_cases = [os.path.splitext(os.path.basename(src))[0]
+                   for src in bench_src_files]
+
+    success = True
+    for case in bench_cases:
+        if not run_benchmark(case):
+            success = False
+
+    if not success:
+        sys.exit(1)
@@ -0,0 +1,74 @@
+import os
+import random
+import statistics
+import subprocess
+import sys
+import tempfile
+import time
+
+ORBC_EXE = sys.argv[1]
+RUNS = int(sys.argv[2]) if len(sys.argv) > 2 else 5
+
+BENCH_LIB_DIR = '../libs/'
+
+LIT_CNT = 1000000
+LITS_PER_LINE = 16
+
+FORM_CNT = 200000
+
+
+# a lookup table of numeric literals in every base, kept in an unused macro so only lexing and parsing cost time
+def generate_num_lits(src_file):
+    rand = random.Random(0)
+    gens = [
+        lambda: str(rand.randint(0, 2**62)),
+        lambda: hex(rand.randint(0, 2**62)),
+        lambda: '0b' + format(rand.randint(0, 2**16), 'b'),
+        lambda: '0' + format(rand.randint(0, 2**30), 'o'),
+        lambda: '{}_{:03}_{:03}'.format(rand.randint(1, 999), rand.randint(0, 999), rand.randint(0, 999)),
+        lambda: repr(rand.random() * 1000.0),
+        lambda: '{:.6e}'.format(rand.random()),
+    ]
+
+    with open(src_file, 'w') as f:
+        f.write('mac numLits () {\n    ret \\(\n')
+        for i in range(0, LIT_CNT, LITS_PER_LINE):
+            lits = [gens[j % len(gens)]() for j in range(i, min(i + LITS_PER_LINE, LIT_CNT))]
+            f.write('        ' + ' '.join(lits) + '\n')
+        f.write('    );\n};\n\nfnc main () () {};\n')
+
+
+# many small top-level forms, each one parsed and then evaluated on its own
+def generate_forms(src_file):
+    with open(src_file, 'w') as f:
+        for i in range(FORM_CNT):
+            f.write('eval (+ (* {}:i64 3) (- {} 7));\n'.format(i, i))
+        f.write('\nfnc main () () {};\n')
+
+
+def time_compile(src_file, obj_file):
+    times = []
+    for _ in range(RUNS):
+        start = time.perf_counter()
+        result = subprocess.run([ORBC_EXE, src_file, '-I' + BENCH_LIB_DIR, '-c', '-o', obj_file])
+        times.append(time.perf_counter() - start)
+        if result.returncode != 0:
+            print('Failed to compile: ' + src_file)
+            sys.exit(1)
+    return times
+
+
+if __name__ == "__main__":
+    # the generated sources are large, so they are not left behind
+    with tempfile.TemporaryDirectory() as bench_bin_dir:
+        src_file = os.path.join(bench_bin_dir, 'bench_num_lits.orb')
+        generate_num_lits(src_file)
+        times = time_compile(src_file, os.path.join(bench_bin_dir, 'bench_num_lits.o'))
+        print('{} numeric literals: compile min {:.3f}s, median {:.3f}s'.format(
+            LIT_CNT, min(times), statistics.median(times)))
+
+        src_file = os.path.join(bench_bin_dir, 'bench_forms.orb')
+        generate_forms(src_file)
+        times = time_compile(src_file, os.path.join(bench_bin_dir, 'bench_forms.o'))
+        print('{} top-level forms: compile min {:.3f}s, median {:.3f}s'.format(
+            FORM_CNT, min(times), statistics.median(times)))
@@ -0,0 +1,57 @@
+import glob
+import os
+import platform
+import subprocess
+import sys
+import tempfile
+
+ORBC_EXE = sys.argv[1]
+
+TEST_POS_DIR = 'positive'
+BENCH_DIR = 'benchmarks'
+BENCH_LIB_DIR = '../libs/'
+
+
+# returns peak resident memory of the compiler in KiB, or None if it failed
+def measure_compile(src_file, bin_dir):
+    case = os.path.splitext(os.path.basename(src_file))[0]
+    obj_file = os.path.join(bin_dir, case + '.o')
+
+    proc = subprocess.Popen([ORBC_EXE, src_file, '-I' + BENCH_LIB_DIR, '-I.', '-c', '-o', obj_file],
+                            stdout=subprocess.DEVNULL, stderr=subprocess.DEVNULL)
+    _, status, usage = os.wait4(proc.pid, 0)
+    proc.returncode = os.waitstatus_to_exitcode(status)
+    if proc.returncode != 0:
+        return None
+
+    # reported in bytes on macOS
+    if platform.system() == 'Darwin':
+        return usage.ru_maxrss // 1024
+    return usage.ru_maxrss
+
+
+if __name__ == "__main__":
+    if not hasattr(os, 'wait4'):
+        print('Measuring memory is not supported on this platform.')
+        sys.exit(1)
+
+    src_files = sorted(glob.glob(TEST_POS_DIR + '/test*.orb')) + sorted(glob.glob(BENCH_DIR + '/bench*.orb'))
+
+    success = True
+    peaks = []
+    with tempfile.TemporaryDirectory() as bench_bin_dir:
+        for src_file in src_files:
+            peak = measure_compile(src_file, bench_bin_dir)
+            if peak is None:
+                print('Failed to compile: ' + src_file)
+                success = False
+                continue
+
+            print('{}: peak {} KiB'.format(src_file, peak))
+            peaks.append(peak)
+
+    if peaks:
+        print('Total over {} files: {} KiB, max {} KiB'.format(len(peaks), sum(peaks), max(peaks)))
+
+    if not success:
+        sys.exit(1)
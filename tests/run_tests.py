@@ -3,6 +3,7 @@ import glob
 import os
 import platform
 import re
+import shutil
 import subprocess
 import sys
 
@@ -10,6 +11,7 @@ ORBC_EXE = sys.argv[1]
 
 TEST_POS_DIR = 'positive'
 TEST_NEG_DIR = 'negative'
+TEST_DRIVER_DIR = 'driver'
 TEST_BIN_DIR = 'bin'
 TEST_LIB_DIR = '../libs/'
 
@@ -33,6 +35,10 @@ def run_positive_test(case):
     if result.returncode != 0:
         return False
 
+    return compare_output(exe_file, cmp_file)
+
+
+def compare_output(exe_file, cmp_file):
     result = subprocess.run(exe_file, stdout=subprocess.PIPE)
     exe_out = result.stdout.decode('utf-8').splitlines()
 
@@ -60,6 +66,417 @@ def run_negative_test(case):
     return result.returncode > 0 and result.returncode < 100
 
 
+# driver tests run the compiler several times with various options, each in its own directory under bin
+def run_orbc(work_dir, args, stderr=None, stdout=None):
+    tests_dir = os.path.abspath('.')
+    lib_dir = os.path.abspath(TEST_LIB_DIR)
+    orbc_exe = os.path.abspath(ORBC_EXE) if os.path.exists(ORBC_EXE) else ORBC_EXE
+    return subprocess.run([orbc_exe] + args + ['-I' + tests_dir, '-I' + lib_dir], cwd=work_dir, stderr=stderr, stdout=stdout)
+
+
+def get_output(exe_file):
+    result = subprocess.run(exe_file, stdout=subprocess.PIPE)
+    return result.stdout.decode('utf-8').splitlines()
+
+
+def driver_src(case):
+    return os.path.abspath(TEST_DRIVER_DIR + '/' + case + '.orb')
+
+
+def driver_cmp(case):
+    return TEST_DRIVER_DIR + '/' + case + '.txt'
+
+
+def driver_test_separate_compilation(work_dir):
+    # a copy, found before the original when imported, as the test changes its modification time
+    os.mkdir(work_dir + '/driver')
+    lib_src = work_dir + '/driver/sep_lib.orb'
+    shutil.copyfile(driver_src('sep_lib'), lib_src)
+
+    # the object is named as the temporary one used to be, so that it would get overwritten
+    if run_orbc(work_dir, ['-c', '-emit-interface', lib_src, '-o', 'a.o']).returncode != 0:
+        return False
+    if not os.path.exists(work_dir + '/a.orbi'):
+        print('Interface not written.')
+        return False
+
+    if run_orbc(work_dir, [driver_src('sep_main'), 'a.o', '-o', 'main', '-MF', 'main.d']).returncode != 0:
+        return False
+    if not compare_output(work_dir + '/main', driver_cmp('sep_main')):
+        return False
+    with open(work_dir + '/main.d', 'r') as file:
+        if 'a.orbi' not in file.read():
+            print('Interface not imported.')
+            return False
+
+    # without the object, the interface must not be imported
+    if run_orbc(work_dir, [driver_src('sep_main'), '-o', 'main_src']).returncode != 0:
+        return False
+    if not compare_output(work_dir + '/main_src', driver_cmp('sep_main')):
+        return False
+
+    # a stale interface is not imported
+    interface_time = os.path.getmtime(work_dir + '/a.orbi')
+    os.utime(work_dir + '/a.orbi', (interface_time - 10, interface_time - 10))
+    os.utime(lib_src, (interface_time, interface_time))
+    if run_orbc(work_dir, [driver_src('sep_main'), 'a.o', '-o', 'main_stale', '-MF', 'main_stale.d']).returncode != 0:
+        return False
+    if not compare_output(work_dir + '/main_stale', driver_cmp('sep_main')):
+        return False
+    with open(work_dir + '/main_stale.d', 'r') as file:
+        if 'a.orbi' in file.read():
+            print('Stale interface imported.')
+            return False
+
+    # interfaces are only written on request, and only then are definitions shared between objects
+    if run_orbc(work_dir, ['-c', '-emit-llvm', lib_src, '-o', 'b.o']).returncode != 0:
+        return False
+    if os.path.exists(work_dir + '/b.orbi'):
+        print('Interface written unrequested.')
+        return False
+    with open(work_dir + '/sep_lib.ll', 'r') as file:
+        if 'weak_odr' in file.read():
+            print('Definitions shared without an interface.')
+            return False
+
+    return True
+
+
+def compile_cached(work_dir, src_file):
+    result = run_orbc(work_dir, ['-O0', '-fcodegen-cache=cache', src_file, '-o', 'main'], stderr=subprocess.PIPE)
+    if result.returncode != 0:
+        print(result.stderr.decode('utf-8'))
+        return None
+
+    match = re.search(r'reused (\d+) of (\d+) objects', result.stderr.decode('utf-8'))
+    if match == None:
+        print('Codegen cache not reported.')
+        return None
+    return int(match.group(1)), int(match.group(2))
+
+
+def driver_test_codegen_cache(work_dir):
+    src_file = work_dir + '/cache_main.orb'
+    shutil.copyfile(driver_src('cache_main'), src_file)
+
+    first = compile_cached(work_dir, src_file)
+    if first == None or not compare_output(work_dir + '/main', driver_cmp('cache_main')):
+        return False
+    if first[0] != 0:
+        print('Empty codegen cache reused {} objects.'.format(first[0]))
+        return False
+
+    second = compile_cached(work_dir, src_file)
+    if second == None or not compare_output(work_dir + '/main', driver_cmp('cache_main')):
+        return False
+    if second != (first[1], first[1]):
+        print('Unchanged program reused {} of {} objects.'.format(*second))
+        return False
+
+    # only the changed function is compiled again
+    with open(src_file, 'r') as file:
+        src = file.read()
+    with open(src_file, 'w') as file:
+        file.write(src.replace('ret (+ x 1);', 'ret (- x -1);'))
+
+    third = compile_cached(work_dir, src_file)
+    if third == None or not compare_output(work_dir + '/main', driver_cmp('cache_main')):
+        return False
+    if third != (first[1] - 1, first[1]):
+        print('Program with one changed function reused {} of {} objects.'.format(*third))
+        return False
+
+    return True
+
+
+def driver_test_lto(work_dir):
+    for mode in ['full', 'thin']:
+        obj_file = 'lib_' + mode + '.o'
+        if run_orbc(work_dir, ['-c', '-emit-interface', '-flto=' + mode, driver_src('sep_lib'), '-o', obj_file]).returncode != 0:
+            return False
+        with open(work_dir + '/' + obj_file, 'rb') as file:
+            if file.read(4) != b'BC\xc0\xde':
+                print('Object for LTO is not bitcode: ' + obj_file)
+                return False
+
+    # only LLD reads the bitcode when linking
+    if shutil.which('clang') == None or shutil.which('ld.lld') == None:
+        print('LTO linking skipped, clang or LLD not found.')
+        return True
+
+    for mode in ['full', 'thin']:
+        exe_file = 'main_' + mode
+        if run_orbc(work_dir, ['-flto=' + mode, driver_src('sep_main'), 'lib_' + mode + '.o', '-o', exe_file]).returncode != 0:
+            return False
+        if not compare_output(work_dir + '/' + exe_file, driver_cmp('sep_main')):
+            return False
+
+    return True
+
+
+# the library is placed in a directory that needs escaping in makefiles, which is passed as an import path
+def setup_deps(work_dir):
+    lib_dir = work_dir + '/lib dir#$' + ('' if platform.system() == 'Windows' else ':')
+    os.mkdir(lib_dir)
+    shutil.copyfile(driver_src('deps_lib'), lib_dir + '/deps_lib.orb')
+    shutil.copyfile(driver_src('deps_main'), work_dir + '/deps_main.orb')
+    return lib_dir
+
+
+def escape_for_makefile(path):
+    escaped = ''
+    for i, c in enumerate(path + '\n'):
+        if c in ' #:\n':
+            escaped += '\\' * (len(path[:i]) - len(path[:i].rstrip('\\')))
+            if c != '\n':
+                escaped += '\\'
+        elif c == '$':
+            escaped += '$'
+        if c != '\n':
+            escaped += c
+    return escaped
+
+
+def check_deps_file(deps_file, target, deps):
+    with open(deps_file, 'r') as file:
+        lines = file.read().splitlines()
+
+    expected = [escape_for_makefile(target) + ': \\'] + \
+        ['  ' + escape_for_makefile(dep) + ' \\' for dep in deps[:-1]] + ['  ' + escape_for_makefile(deps[-1])]
+    if lines != expected:
+        print('Unexpected dependencies in ' + deps_file + ':')
+        for line in difflib.unified_diff(lines, expected, lineterm=''):
+            print(line)
+        return False
+    return True
+
+
+def driver_test_deps(work_dir):
+    lib_dir = setup_deps(work_dir)
+    deps = [work_dir + '/deps_main.orb', os.path.abspath('util/print.orb'),
+            os.path.abspath(TEST_LIB_DIR + '/clib.orb'), lib_dir + '/deps_lib.orb']
+
+    if run_orbc(work_dir, ['-MD', '-I' + lib_dir, 'deps_main.orb', '-o', 'main']).returncode != 0:
+        return False
+    if not check_deps_file(work_dir + '/main.d', 'main', deps):
+        return False
+
+    if run_orbc(work_dir, ['-MF', 'custom.d', '-I' + lib_dir, 'deps_main.orb', '-o', 'main']).returncode != 0:
+        return False
+    if os.path.exists(work_dir + '/custom.o') or not check_deps_file(work_dir + '/custom.d', 'main', deps):
+        return False
+
+    return True
+
+
+def driver_test_skip_if_up_to_date(work_dir):
+    lib_dir = setup_deps(work_dir)
+    exe_file = work_dir + '/main'
+    args = ['-skip-if-up-to-date', '-I' + lib_dir, 'deps_main.orb', '-o', 'main']
+
+    def compile_and_check(expect_compiled, expect_out):
+        mtime_prev = os.stat(exe_file).st_mtime_ns if os.path.exists(exe_file) else None
+        # so that compiling again is seen, even on coarse file times
+        if mtime_prev != None:
+            os.utime(exe_file, ns=(mtime_prev - 10**9, mtime_prev - 10**9))
+            mtime_prev -= 10**9
+
+        if run_orbc(work_dir, args).returncode != 0:
+            return False
+        compiled = os.stat(exe_file).st_mtime_ns != mtime_prev
+        if compiled != expect_compiled:
+            print('Output was compiled again.' if compiled else 'Output was not compiled again.')
+            return False
+        return get_output(exe_file) == expect_out
+
+    def touch(path):
+        now = os.stat(exe_file).st_mtime + 10
+        os.utime(path, (now, now))
+
+    if not compile_and_check(True, ['1']) or not compile_and_check(False, ['1']):
+        return False
+
+    # touched, but not changed
+    touch(lib_dir + '/deps_lib.orb')
+    if not compile_and_check(False, ['1']):
+        return False
+
+    with open(lib_dir + '/deps_lib.orb', 'r') as file:
+        src = file.read()
+    with open(lib_dir + '/deps_lib.orb', 'w') as file:
+        file.write(src.replace('println_i32 1', 'println_i32 2'))
+    touch(lib_dir + '/deps_lib.orb')
+    if not compile_and_check(True, ['2']) or not compile_and_check(False, ['2']):
+        return False
+
+    # the working directory is searched before import paths
+    with open(work_dir + '/deps_lib.orb', 'w') as file:
+        file.write(src.replace('println_i32 1', 'println_i32 3'))
+    if not compile_and_check(True, ['3']):
+        return False
+
+    # compiling differently
+    args.insert(0, '-O1')
+    if not compile_and_check(True, ['3']):
+        return False
+
+    return True
+
+
+# every positive test has to behave the same when compiled with these arguments
+def run_positive_tests_with(work_dir, args):
+    for src_file in sorted(glob.glob(TEST_POS_DIR + '/*.orb')):
+        case = os.path.splitext(os.path.basename(src_file))[0]
+        exe_file = work_dir + '/' + case
+        if platform.system() == 'Windows':
+            exe_file += '.exe'
+        stderr = subprocess.DEVNULL if case in TESTS_POS_SILENT else None
+        if run_orbc(work_dir, args + [os.path.abspath(src_file), '-o', exe_file], stderr).returncode != 0:
+            print('Failed to compile ' + case + ' with ' + ' '.join(args) + '.')
+            return False
+        if not compare_output(exe_file, TEST_POS_DIR + '/' + case + '.txt'):
+            return False
+    return True
+
+
+def driver_test_debug_info(work_dir):
+    # debug info must also pass verification
+    if not run_positive_tests_with(work_dir, ['-g']) or not run_positive_tests_with(work_dir, ['-gline-tables-only']):
+        return False
+
+    if run_orbc(work_dir, ['-g', '-c', driver_src('debug_main'), '-o', 'debug_main.o']).returncode != 0:
+        return False
+
+    if shutil.which('llvm-dwarfdump') == None:
+        print('Checking debug info skipped, llvm-dwarfdump not found.')
+        return True
+
+    def dwarfdump(section):
+        result = subprocess.run(['llvm-dwarfdump', section, 'debug_main.o'], cwd=work_dir, stdout=subprocess.PIPE)
+        return result.stdout.decode('utf-8')
+
+    # main is declared on line 10, the macro invoked on line 12, and its body prints on lines 5 and 6
+    lines = dwarfdump('--debug-line')
+    file_index = re.search(r'file_names\[\s*(\d+)\]:\s*name: "debug_main.orb"', lines)
+    if file_index == None or \
+        re.search(r'^0x[0-9a-f]+\s+10\s+\d+\s+' + file_index.group(1) + r'\s', lines, re.MULTILINE) == None:
+        print('Line table has no row for main in debug_main.orb.')
+        return False
+
+    inlined = re.findall(r'DW_TAG_inlined_subroutine\s+DW_AT_abstract_origin\s+\(0x[0-9a-f]+ "([^"]*)"\)'
+                         r'(?:\s+DW_AT_\w+\s+\(.*\))*?\s+DW_AT_call_file\s+\("([^"]*)"\)\s+DW_AT_call_line\s+\((\d+)\)',
+                         dwarfdump('--debug-info'))
+    inlined = [(name, os.path.basename(file), int(line)) for name, file, line in inlined]
+    for expected in [('printTwice', 'debug_main.orb', 12),
+                     ('println_i32$f$a1$p$i32', 'debug_main.orb', 5),
+                     ('println_i32$f$a1$p$i32', 'debug_main.orb', 6)]:
+        if expected not in inlined:
+            print('No inlined subroutine entry for ' + expected[0] + ' at line ' + str(expected[2]) + '.')
+            return False
+
+    return True
+
+
+def driver_test_pgo(work_dir):
+    if run_orbc(work_dir, ['-fprofile-generate', '-c', driver_src('debug_main'), '-o', 'instr.o']).returncode != 0:
+        return False
+    with open(work_dir + '/instr.o', 'rb') as file:
+        if b'__llvm_profile' not in file.read():
+            print('Instrumented object has no profile symbols.')
+            return False
+
+    with open(work_dir + '/bad.profdata', 'w') as file:
+        file.write('not a profile\n')
+    for profile in ['missing.profdata', 'bad.profdata', '.']:
+        result = run_orbc(work_dir, ['-fprofile-use=' + profile, driver_src('debug_main'), '-o', 'main'],
+                          subprocess.PIPE, subprocess.DEVNULL)
+        if result.returncode <= 0 or result.returncode >= 100 or \
+            ("'" + profile + "'") not in result.stderr.decode('utf-8'):
+            print('Profile ' + profile + ' was not diagnosed.')
+            return False
+
+    if shutil.which('llvm-profdata') == None:
+        print('Using a profile skipped, llvm-profdata not found.')
+        return True
+
+    with open(work_dir + '/empty.proftext', 'w') as file:
+        file.write('# IR level Instrumentation Flag\n:ir\n')
+    if subprocess.run(['llvm-profdata', 'merge', '-o', 'empty.profdata', 'empty.proftext'], cwd=work_dir).returncode != 0:
+        return False
+    if run_orbc(work_dir, ['-fprofile-use=empty.profdata', driver_src('debug_main'), '-o', 'main']).returncode != 0:
+        return False
+
+    return get_output(work_dir + '/main') == ['5', '5']
+
+
+# imports are prefetched by default only if there are spare hardware threads
+def driver_test_import_workers(work_dir):
+    return run_positive_tests_with(work_dir, ['-fimport-workers=4']) and \
+        run_positive_tests_with(work_dir, ['-fimport-workers=0'])
+
+
+# members of packed data are accessed without assuming the alignment of their types
+def driver_test_packed_alignment(work_dir):
+    if run_orbc(work_dir, ['-O0', '-emit-llvm', driver_src('packed_main'), '-o', 'main']).returncode != 0:
+        return False
+    if get_output(work_dir + '/main') != ['7']:
+        return False
+
+    with open(work_dir + '/packed_main.ll', 'r') as file:
+        main_body = re.search(r'^define void @main\(\) {$(.*?)^}$', file.read(), re.MULTILINE | re.DOTALL)
+    accesses = re.findall(r'^\s*(?:%\w+ = load i32, i32\* %\w+|store i32 7, i32\* %\w+), align (\d+)$',
+                          main_body.group(1) if main_body else '', re.MULTILINE)
+    if not accesses or any(align != '1' for align in accesses):
+        print('Packed member accessed with alignments ' + str(accesses) + '.')
+        return False
+
+    return True
+
+
+def driver_test_no_name_mangle_abi(work_dir):
+    if run_orbc(work_dir, ['-O0', '-emit-llvm', driver_src('nomangle_main'), '-o', 'main']).returncode != 0:
+        return False
+    if get_output(work_dir + '/main') != ['6', '7']:
+        return False
+
+    # foreign code expects aggregates by value, but calls through function values go through a by-ref thunk
+    with open(work_dir + '/nomangle_main.ll', 'r') as file:
+        ir = file.read()
+    if not re.search(r'^define \w+ %Big @bigBump\(%Big %\d+\)', ir, re.MULTILINE):
+        print('Function with no name mangling does not take and return its aggregate by value.')
+        return False
+    if not re.search(r'^define \w+ void @bigBump\.byref\(%Big\* noalias sret', ir, re.MULTILINE):
+        print('Function value with no name mangling does not use the by-ref thunk.')
+        return False
+
+    return True
+
+
+DRIVER_TESTS = [
+    driver_test_separate_compilation,
+    driver_test_codegen_cache,
+    driver_test_lto,
+    driver_test_deps,
+    driver_test_skip_if_up_to_date,
+    driver_test_debug_info,
+    driver_test_pgo,
+    driver_test_import_workers,
+    driver_test_packed_alignment,
+    driver_test_no_name_mangle_abi,
+]
+
+
+def run_driver_test(test):
+    case = test.__name__[len('driver_test_'):]
+    print('Driver test: ' + case)
+
+    work_dir = os.path.abspath(TEST_BIN_DIR + '/' + case)
+    shutil.rmtree(work_dir, ignore_errors=True)
+    os.mkdir(work_dir)
+
+    return test(work_dir)
+
+
 def run_all_tests(dir, test_func):
     re_pattern = re.compile(r'(test.*)\.orb', re.IGNORECASE)
     test_src_files = glob.glob(dir + '/test*.orb')
@@ -82,7 +499,8 @@ if __name__ == "__main__":
         os.mkdir(TEST_BIN_DIR)
 
     if not run_all_tests(TEST_POS_DIR, run_positive_test) \
-        or not run_all_tests(TEST_NEG_DIR, run_negative_test):
+        or not run_all_tests(TEST_NEG_DIR, run_negative_test) \
+        or not all(run_driver_test(test) for test in DRIVER_TESTS):
         print('Test failed!')
     else:
         print('Tests ran successfully.')